@@ -0,0 +1,101 @@
+#include "affinity.hpp"
+
+#include "logging.hpp"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <pthread.h>
+#include <sched.h>
+#define WITH_AFFINITY
+#endif
+
+namespace{
+
+#ifdef WITH_AFFINITY
+// read a sysfs list such as "0-3,8-11"
+std::vector<int> readList(const std::string & path){
+    std::vector<int> l;
+    std::ifstream str(path);
+    std::string line;
+    if ( !str.is_open() || !std::getline(str,line) ) return l;
+    std::stringstream ss(line);
+    std::string range;
+    while (std::getline(ss,range,',')){
+        if ( range.empty() ) continue;
+        const size_t dash = range.find('-');
+        const int first = std::atoi(range.substr(0,dash).c_str());
+        const int last  = dash == std::string::npos ? first : std::atoi(range.substr(dash+1).c_str());
+        for (int n = first; n <= last; ++n) l.push_back(n);
+    }
+    return l;
+}
+
+int readInt(const std::string & path, int def){
+    std::ifstream str(path);
+    int v = def;
+    if ( !str.is_open() || !(str >> v) ) return def;
+    return v;
+}
+
+std::vector<int> buildOrder(){
+    struct CPU{ int id, node, smtRank, coreRank; };
+    std::vector<CPU> cpus;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if ( sched_getaffinity(0, sizeof(allowed), &allowed) != 0 ) return std::vector<int>();
+    std::map<int,int> nodeOf;
+    for (int node = 0 ; node < 64 ; ++node) for (int c : readList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")) nodeOf[c] = node;
+    std::map<std::pair<int,int>,int> siblingCount; // (package,core) -> number of logical CPUs already seen
+    std::map<std::pair<int,int>,int> coreCount;    // (node,smtRank) -> number of cores already seen
+    for (int c = 0 ; c < CPU_SETSIZE ; ++c){
+        if ( !CPU_ISSET(c, &allowed) ) continue;
+        const std::string topo = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+        const std::pair<int,int> core(readInt(topo + "physical_package_id", 0), readInt(topo + "core_id", c));
+        const int node = nodeOf.count(c) ? nodeOf[c] : 0;
+        const int smtRank = siblingCount[core]++;
+        cpus.push_back({c, node, smtRank, coreCount[std::make_pair(node,smtRank)]++});
+    }
+    // physical cores first, then round robin over NUMA nodes
+    std::stable_sort(cpus.begin(), cpus.end(), [](const CPU & a, const CPU & b){
+        if ( a.smtRank != b.smtRank ) return a.smtRank < b.smtRank;
+        if ( a.coreRank != b.coreRank ) return a.coreRank < b.coreRank;
+        return a.node < b.node; });
+    std::vector<int> order;
+    for (const auto & cpu : cpus) order.push_back(cpu.id);
+    std::set<int> nodes;
+    for (const auto & cpu : cpus) nodes.insert(cpu.node);
+    const size_t cores = std::count_if(cpus.begin(), cpus.end(), [](const CPU & cpu){ return cpu.smtRank == 0; });
+    Logging::LogIt(Logging::logInfo) << "Affinity : " << order.size() << " logical CPUs, " << cores << " physical cores, " << nodes.size() << " NUMA nodes";
+    return order;
+}
+#endif
+
+} // anonymous
+
+namespace Affinity{
+
+const std::vector<int> & cpuOrder(){
+#ifdef WITH_AFFINITY
+    static const std::vector<int> order = buildOrder();
+#else
+    static const std::vector<int> order;
+#endif
+    return order;
+}
+
+void bindThisThread(size_t idx){
+#ifdef WITH_AFFINITY
+    const std::vector<int> & order = cpuOrder();
+    if ( order.empty() ){ Logging::LogIt(Logging::logWarn) << "CPU topology not available, thread " << idx << " not pinned"; return; }
+    const int cpu = order[idx % order.size()];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if ( pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0 ) Logging::LogIt(Logging::logWarn) << "Cannot pin thread " << idx << " to CPU " << cpu;
+    else Logging::LogIt(Logging::logInfo) << "Thread " << idx << " pinned to CPU " << cpu;
+#else
+    ///@todo SetThreadGroupAffinity on Windows
+    Logging::LogIt(Logging::logWarn) << "Thread affinity not available on this platform, thread " << idx << " not pinned";
+#endif
+}
+
+} // Affinity
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "definition.hpp"
+
+/* Thread placement for the search threads
+ * Logical CPUs are ordered so that each thread gets its own physical core first, cores being
+ * spread evenly over NUMA nodes, and SMT siblings are only used once all physical cores are taken.
+ * Only CPUs allowed for the process (taskset, cgroups) are used.
+ */
+
+namespace Affinity{
+
+// logical CPUs in placement order, empty if the topology is not available
+const std::vector<int> & cpuOrder();
+
+// pin the calling thread to the idx-th CPU of cpuOrder() (modulo its size)
+void bindThisThread(size_t idx);
+
+} // Affinity
@@ -0,0 +1,195 @@
+#include "allocator.hpp"
+
+#include "bitboard.hpp"
+#include "logging.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace{
+
+enum AllocType : unsigned char { at_std = 0, at_mmap, at_virtual, at_file, at_shared };
+struct Block{ size_t size; AllocType type; void * base; };
+
+// allocations are rare, a map is enough to remember how to release them.
+// Never destroyed, so that static tables can still be released at exit whatever the destruction order is.
+std::mutex & mutex(){ static std::mutex * m = new std::mutex; return *m; }
+std::map<void*,Block> & blocks(){ static std::map<void*,Block> * b = new std::map<void*,Block>; return *b; }
+
+const size_t hugePageSize = 2*1024*1024;
+const size_t pageSize     = 4*1024;
+
+#if defined(__linux__) && defined(SYS_mbind)
+// build the mask of online NUMA nodes from something like "0-1" or "0,2-3"
+unsigned long long int onlineNodes(){
+    unsigned long long int mask = 0ull;
+    std::ifstream str("/sys/devices/system/node/online");
+    std::string line;
+    if ( !str.is_open() || !std::getline(str,line) ) return mask;
+    std::stringstream ss(line);
+    std::string range;
+    while (std::getline(ss,range,',')){
+        const size_t dash = range.find('-');
+        const int first = std::atoi(range.substr(0,dash).c_str());
+        const int last  = dash == std::string::npos ? first : std::atoi(range.substr(dash+1).c_str());
+        for (int n = first; n <= last && n < 64; ++n) mask |= 1ull << n;
+    }
+    return mask;
+}
+#endif
+
+void applyPolicy(void * ptr, size_t size, Allocator::NUMAPolicy policy){
+    if ( policy != Allocator::numa_interleave ) return; // first-touch is the default kernel policy
+#if defined(__linux__) && defined(SYS_mbind)
+    const unsigned long long int mask = onlineNodes();
+    if ( countBit(mask) < 2 ){ Logging::LogIt(Logging::logInfo) << "Single NUMA node, interleave policy ignored"; return; }
+    const int mpolInterleave = 3; // MPOL_INTERLEAVE from numaif.h, we don't want to depend on libnuma
+    if ( syscall(SYS_mbind, ptr, size, mpolInterleave, &mask, sizeof(mask)*8, 0) != 0 ) Logging::LogIt(Logging::logWarn) << "Cannot interleave memory over NUMA nodes";
+    else Logging::LogIt(Logging::logInfo) << "Memory interleaved over " << countBit(mask) << " NUMA nodes";
+#else
+    (void)ptr; (void)size;
+    Logging::LogIt(Logging::logWarn) << "NUMA interleave policy not available on this platform";
+#endif
+}
+
+} // anonymous
+
+namespace Allocator{
+
+void * alloc(size_t size, bool largePages, NUMAPolicy policy){
+    void * ptr = nullptr;
+    Block block = {size, at_std, nullptr};
+    std::string kind = "standard pages";
+#ifdef _WIN32
+    (void)largePages; ///@todo large pages need SeLockMemoryPrivilege on Windows
+    ptr = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if ( ptr ) block.type = at_virtual;
+    else ptr = _aligned_malloc(size, pageSize);
+#else
+    if ( largePages && 2*size >= hugePageSize ){ // huge pages are only worth it for big tables (a Searcher is about 1.6Mb)
+        const size_t roundedSize = ((size + hugePageSize - 1) / hugePageSize) * hugePageSize;
+#ifdef MAP_HUGETLB
+        // explicit huge pages, only available if reserved by the admin (vm.nr_hugepages)
+        ptr = mmap(nullptr, roundedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if ( ptr == MAP_FAILED ) ptr = nullptr;
+        else { block = {roundedSize, at_mmap, nullptr}; kind = "explicit huge pages"; }
+#endif
+#ifdef MADV_HUGEPAGE
+        // transparent huge pages, the kernel will do its best if aligned and advised
+        if ( !ptr && posix_memalign(&ptr, hugePageSize, roundedSize) == 0 ){
+            block.size = roundedSize;
+            if ( madvise(ptr, roundedSize, MADV_HUGEPAGE) == 0 ) kind = "transparent huge pages";
+        }
+#endif
+    }
+    if ( !ptr && posix_memalign(&ptr, pageSize, size) != 0 ) ptr = nullptr;
+#endif
+    if ( !ptr ){
+        Logging::LogIt(Logging::logFatal) << "Cannot allocate " << size/1024 << "Kb";
+        return nullptr;
+    }
+    applyPolicy(ptr, block.size, policy);
+    Logging::LogIt(Logging::logInfo) << "Allocated " << block.size/1024 << "Kb using " << kind;
+    std::lock_guard<std::mutex> lock(mutex());
+    blocks()[ptr] = block;
+    return ptr;
+}
+
+void * mapFile(const std::string & path, size_t offset, size_t & size){
+    size = 0;
+#ifdef _WIN32
+    (void)offset;
+    Logging::LogIt(Logging::logError) << "Mapping a file is not available on this platform (" << path << ")";
+    return nullptr;
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if ( fd < 0 ){ Logging::LogIt(Logging::logError) << "Cannot open " << path; return nullptr; }
+    struct stat st;
+    if ( fstat(fd, &st) != 0 || (size_t)st.st_size <= offset ){ close(fd); Logging::LogIt(Logging::logError) << "Bad file size " << path; return nullptr; }
+    const size_t fileSize = (size_t)st.st_size;
+    // private mapping, the table can be modified without touching the file
+    void * base = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if ( base == MAP_FAILED ){ Logging::LogIt(Logging::logError) << "Cannot map " << path; return nullptr; }
+    madvise(base, fileSize, MADV_RANDOM); // no read-ahead, accesses are random
+    void * ptr = (char*)base + offset;
+    size = fileSize - offset;
+    Logging::LogIt(Logging::logInfo) << "Mapped " << fileSize/1024 << "Kb from " << path;
+    std::lock_guard<std::mutex> lock(mutex());
+    blocks()[ptr] = {fileSize, at_file, base};
+    return ptr;
+#endif
+}
+
+void * allocShared(const std::string & name, size_t offset, size_t & size, bool & created){
+    created = false;
+#if defined(__linux__) && !defined(__ANDROID__)
+    const std::string shmName = "/" + name;
+    int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if ( fd >= 0 ){
+        created = true;
+        if ( ftruncate(fd, off_t(offset + size)) != 0 ){
+            close(fd); shm_unlink(shmName.c_str());
+            Logging::LogIt(Logging::logError) << "Cannot size shared memory " << name;
+            return nullptr;
+        }
+    }
+    else{
+        fd = shm_open(shmName.c_str(), O_RDWR, 0600);
+        struct stat st;
+        if ( fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size <= offset ){
+            if ( fd >= 0 ) close(fd);
+            Logging::LogIt(Logging::logError) << "Cannot attach to shared memory " << name;
+            return nullptr;
+        }
+        size = (size_t)st.st_size - offset;
+    }
+    void * base = mmap(nullptr, offset + size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( base == MAP_FAILED ){ Logging::LogIt(Logging::logError) << "Cannot map shared memory " << name; return nullptr; }
+    void * ptr = (char*)base + offset;
+    Logging::LogIt(Logging::logInfo) << (created ? "Created " : "Attached to ") << "shared memory " << name << " " << (offset + size)/1024 << "Kb";
+    std::lock_guard<std::mutex> lock(mutex());
+    blocks()[ptr] = {offset + size, at_shared, base};
+    return ptr;
+#else
+    (void)offset; (void)size;
+    Logging::LogIt(Logging::logError) << "Shared memory is not available on this platform (" << name << ")";
+    return nullptr;
+#endif
+}
+
+void free(void * ptr){
+    if ( !ptr ) return;
+    Block block;
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        auto it = blocks().find(ptr);
+        if ( it == blocks().end() ){ Logging::LogIt(Logging::logError) << "Trying to free an unknown memory block"; return; }
+        block = it->second;
+        blocks().erase(it);
+    }
+    switch(block.type){
+#ifdef _WIN32
+    case at_virtual: VirtualFree(ptr, 0, MEM_RELEASE); break;
+    case at_std:     _aligned_free(ptr);               break;
+#else
+    case at_mmap:    munmap(ptr, block.size);          break;
+    case at_file:
+    case at_shared:  munmap(block.base, block.size);   break;
+    case at_std:     ::free(ptr);                      break;
+#endif
+    default: break;
+    }
+}
+
+} // Allocator
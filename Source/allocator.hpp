@@ -0,0 +1,35 @@
+#pragma once
+
+#include "definition.hpp"
+
+/* Allocation layer for big tables (TT, pawn table, Searcher and its history tables)
+ * Memory is backed by huge pages when possible (explicit hugetlbfs pages first, then transparent
+ * huge pages) and falls back to standard pages otherwise.
+ * A NUMA placement policy can be given : first-touch (the default kernel policy, pages are
+ * placed on the node of the thread that touches them first) or interleaved over all nodes.
+ * Content of the returned memory is undefined, nothing is touched here.
+ * A file can also be mapped in memory (private copy-on-write mapping, paged in lazily).
+ * Memory can also be a named POSIX shared memory segment, so that it is shared between processes
+ * (such a segment is not removed when released, use "rm /dev/shm/<name>" to do so).
+ */
+
+namespace Allocator{
+
+enum NUMAPolicy : unsigned char { numa_firstTouch = 0, numa_interleave = 1 };
+
+void * alloc(size_t size, bool largePages, NUMAPolicy policy = numa_firstTouch);
+
+// map the file content starting at offset (shall be a multiple of the page size), size is the mapped size from offset
+void * mapFile(const std::string & path, size_t offset, size_t & size);
+
+// attach to (or create if needed) the named shared memory segment, starting at offset (shall be a multiple of the page size)
+// if the segment already exists, size is updated to its size from offset. Memory of a created segment is zeroed.
+void * allocShared(const std::string & name, size_t offset, size_t & size, bool & created);
+
+void free(void * ptr);
+
+struct Deleter{
+    void operator()(void * ptr)const{ Allocator::free(ptr); }
+};
+
+} // Allocator
@@ -221,6 +221,11 @@ BitBoard allAttackedBB(const Position &p, const Square x, Color c) {
     else               return attack<P_wb>(x, p.whiteBishop() | p.whiteQueen(), p.occupancy) | attack<P_wr>(x, p.whiteRook() | p.whiteQueen(), p.occupancy) | attack<P_wn>(x, p.whiteKnight()) | attack<P_wp>(x, p.whitePawn(), p.occupancy, Co_Black) | attack<P_wk>(x, p.whiteKing());
 }
 
+BitBoard allAttackedBB(const Position &p, const Square x, Color c, BitBoard occupancy) {
+    const Color opp = ~c;
+    return attack<P_wb>(x, p.pieces<P_wb>(opp) | p.pieces<P_wq>(opp), occupancy) | attack<P_wr>(x, p.pieces<P_wr>(opp) | p.pieces<P_wq>(opp), occupancy) | attack<P_wn>(x, p.pieces<P_wn>(opp)) | attack<P_wp>(x, p.pieces<P_wp>(opp), occupancy, c) | attack<P_wk>(x, p.pieces<P_wk>(opp));
+}
+
 } // BBTools
 
 bool isAttacked(const Position & p, const Square k) {
@@ -103,7 +103,8 @@ template < Piece pp > inline BitBoard attack(const Square x, const BitBoard targ
 
 #endif // MAGIC
 
-// Those are convenient function pointers for coverage and attack
+// Those are convenient function pointers for coverage and attack, when the piece type is only known at run time
+// (use coverage<T> directly otherwise, so that it is inlined)
 constexpr BitBoard(*const pfCoverage[])(const Square, const BitBoard, const Color)                 = { &BBTools::coverage<P_wp>, &BBTools::coverage<P_wn>, &BBTools::coverage<P_wb>, &BBTools::coverage<P_wr>, &BBTools::coverage<P_wq>, &BBTools::coverage<P_wk> };
 //constexpr BitBoard(*const pfAttack[])  (const Square, const BitBoard, const BitBoard, const Color) = { &BBTools::attack<P_wp>,   &BBTools::attack<P_wn>,   &BBTools::attack<P_wb>,   &BBTools::attack<P_wr>,   &BBTools::attack<P_wq>,   &BBTools::attack<P_wk>   };
 
@@ -112,6 +113,8 @@ bool     isAttackedBB (const Position &p, const Square x, Color c);
 
 // Convenient function to return the bitboard of all attacker of a specific square
 BitBoard allAttackedBB(const Position &p, const Square x, Color c);
+// Same but with a given occupancy (for instance without the king, or after an en-passant capture)
+BitBoard allAttackedBB(const Position &p, const Square x, Color c, BitBoard occupancy);
 
 } // BBTools
 
@@ -5,6 +5,7 @@
 #include "book.hpp"
 #include "evalDef.hpp"
 #include "logging.hpp"
+#include "moveSort.hpp"
 #include "searcher.hpp"
 #include "timeMan.hpp"
 #include "tools.hpp"
@@ -38,16 +39,25 @@ Counter perft(const Position & p, DepthType depth, PerftAccumulator & acc){
     int validMoves = 0;
     int allMoves = 0;
 #ifndef DEBUG_PERFT
-    MoveGen::generate<MoveGen::GP_all>(p,moves);
+    MoveGen::generateLegal<MoveGen::GP_all>(p,moves);
+    if ( depth == 1 ) { acc.pseudoNodes += moves.size(); acc.validNodes += moves.size(); return acc.validNodes; } // bulk counting, moves are legal
     for (auto it = moves.begin() ; it != moves.end(); ++it){
         const Move m = *it;
+        ++allMoves;
+#ifdef WITH_MAKE_UNMAKE
+        const ScopedMove move(p,m,true);
+        const Position & p2 = p;
+#else
+        Position p2 = p;
+        apply(p2,m,true);
+#endif
 #else
     for ( MiniMove m = std::numeric_limits<MiniMove>::min(); m < std::numeric_limits<MiniMove>::max(); ++m){
         if( !isPseudoLegal(p,m) ) continue;
-#endif
         ++allMoves;
         Position p2 = p;
         if ( ! apply(p2,m) ) continue;
+#endif
         ++validMoves;
         perft(p2,depth-1,acc);
     }
@@ -66,6 +76,206 @@ void perft_test(const std::string & fen, DepthType d, unsigned long long int exp
     Logging::LogIt(Logging::logInfo) << "#########################" ;
 }
 
+namespace{
+// the perft test positions (at lower depths), self tests are checking every node of their trees
+const std::pair<std::string,DepthType> selfTestPositions[] = {
+    {startPosition, 4},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - ", 3},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - ", 5},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4},
+};
+
+// check is called on each node of the legal move tree, walk stops at the first failed check
+template < typename F >
+bool walkTree(const Position & p, DepthType depth, F & check){
+    if ( !check(p) ) return false;
+    if ( depth == 0 ) return true;
+    MoveList moves;
+    MoveGen::generateLegal<MoveGen::GP_all>(p,moves);
+    for (const Move m : moves){
+        Position p2 = p;
+        apply(p2,m,true);
+        if ( !walkTree(p2,depth-1,check) ) return false;
+    }
+    return true;
+}
+
+// check shall log what is wrong and return false, the test then stops and gives the process exit code
+// (not a fatal log, exit() would then be called with the logging mutex held)
+template < typename F >
+int selfTest(const std::string & name, F check){
+    Counter nodes = 0;
+    auto counted = [&](const Position & p){ ++nodes; return check(p); };
+    for (const auto & t : selfTestPositions){
+        Position p;
+        readFEN(t.first,p,true);
+        if ( !walkTree(p,t.second,counted) ){
+            Logging::LogIt(Logging::logError) << name << " failed in the tree of " << t.first;
+            return 1;
+        }
+    }
+    Logging::LogIt(Logging::logInfo) << name << " ok (" << nodes << " nodes)";
+    return 0;
+}
+
+// same moves, whatever the order (and the score bits)
+bool sameMoveSet(MoveList a, MoveList b){
+    if ( a.size() != b.size() ) return false;
+    for (Move & m : a) m = Move2MiniMove(m);
+    for (Move & m : b) m = Move2MiniMove(m);
+    std::sort(a.begin(),a.end());
+    std::sort(b.begin(),b.end());
+    return std::equal(a.begin(),a.end(),b.begin());
+}
+
+std::string movesToString(const MoveList & moves){
+    std::string s;
+    for (const Move m : moves) s += ToString(m) + " ";
+    return s;
+}
+
+// the legal generator (evasions when in check) shall give the pseudo-legal moves that apply accepts, phase by phase
+template < MoveGen::GenPhase phase >
+bool checkLegalPhase(const Position & p){
+    MoveList legal, pseudo, expected;
+    MoveGen::generateLegal<phase>(p,legal);
+    MoveGen::generate<phase>(p,pseudo);
+    for (const Move m : pseudo){
+        Position p2 = p;
+        if ( apply(p2,m) ) expected.push_back(m);
+    }
+    if ( !sameMoveSet(legal,expected) ){ Logging::LogIt(Logging::logError) << "Legal moves " << movesToString(legal) << "instead of " << movesToString(expected) << ToString(p); return false; }
+    return true;
+}
+
+bool checkLegal(const Position & p){
+    return checkLegalPhase<MoveGen::GP_all>(p) && checkLegalPhase<MoveGen::GP_cap>(p) && checkLegalPhase<MoveGen::GP_quiet>(p);
+}
+
+#ifdef WITH_MAKE_UNMAKE
+// byte comparison, but the P_none bitboard, which is only a sink for setBit/unSetBit with an empty square, is not part of the position
+bool samePosition(Position a, Position b){
+    a.allB[P_none+PieceShift] = b.allB[P_none+PieceShift] = empty;
+    return std::memcmp(&a,&b,sizeof(Position)) == 0;
+}
+
+// make/unmake shall give the same child as copy/make, and restore the position exactly (also after an invalid move)
+bool checkMakeUnmake(const Position & p){
+    MoveList moves;
+    MoveGen::generate<MoveGen::GP_all>(p,moves);
+    Position q = p;
+    for (const Move m : moves){
+        Position p2 = p;
+        const bool valid = apply(p2,m);
+        UndoInfo u;
+        const bool validU = apply(q,m,u);
+        if ( valid != validU ){ Logging::LogIt(Logging::logError) << "Make/unmake validity differs for " << ToString(m) << ToString(p); return false; }
+        if ( valid && !samePosition(p2,q) ){ Logging::LogIt(Logging::logError) << "Make/unmake child differs for " << ToString(m) << ToString(p) << ToString(q); return false; }
+        unapply(q,m,u);
+        if ( !samePosition(p,q) ){ Logging::LogIt(Logging::logError) << "Unmake does not restore the position for " << ToString(m) << ToString(p) << ToString(q); return false; }
+    }
+    return true;
+}
+#endif
+
+// keys of the child computed before the move is made shall be the ones apply gives, and the ones computed from scratch
+bool checkKeyAfter(const Position & p){
+    MoveList moves;
+    MoveGen::generate<MoveGen::GP_all>(p,moves);
+    for (const Move m : moves){
+        const Hash h = keyAfter(p,m);
+        const Hash ph = pawnKeyAfter(p,m);
+        Position p2 = p;
+        if ( !apply(p2,m) ) continue;
+        Position p3 = p2;
+        p3.h = nullHash;
+        p3.ph = nullHash;
+        const Hash hScratch = computeHash(p3);
+        const Hash phScratch = computePHash(p3);
+        if ( h != hScratch || h != p2.h || ph != phScratch || ph != p2.ph ){
+            Logging::LogIt(Logging::logError) << "Key after " << ToString(m) << " is " << h << " " << ph << ", apply gives " << p2.h << " " << p2.ph << ", from scratch " << hScratch << " " << phScratch << ToString(p);
+            return false;
+        }
+    }
+    return true;
+}
+
+// the staged picker shall give each legal move once, except the TT move (tried by pvs itself), and never an illegal move as legal
+bool checkPicker(const Position & p){
+    Searcher & context = ThreadPool::instance().main();
+    MoveList legal;
+    MoveGen::generateLegal<MoveGen::GP_all>(p,legal);
+    if ( legal.empty() ) return true;
+    const Move ttMove = legal[legal.size()/2];
+    const TT::Entry e(computeHash(p),ttMove,0,0,TT::B_exact,1);
+    // killers of the previous node are not valid here most of the time, that is checked too
+    context.killerT.killers[0][1] = context.killerT.killers[0][0];
+    context.killerT.killers[0][0] = legal.back();
+    CMHPtrArray cmhPtr;
+    cmhPtr.fill(0);
+    const bool isInCheck = isAttacked(p, kingSquare(p));
+    MovePicker mp(context,p,0.5f,0,cmhPtr,isInCheck ? MovePicker::PM_all : MovePicker::PM_main,isInCheck,&e);
+    MoveList expected, picked;
+    for (const Move m : legal) if ( isInCheck || !sameMove(m,ttMove) ) expected.push_back(m);
+    Move m = INVALIDMOVE;
+    while ( (m = mp.next()) != INVALIDMOVE ){
+        Position p2 = p;
+        const bool valid = apply(p2,m);
+        if ( !valid && mp.legalOnly() ){ Logging::LogIt(Logging::logError) << "Picker gives an illegal move as legal " << ToString(m) << ToString(p); return false; }
+        if ( valid ) picked.push_back(m);
+    }
+    if ( !sameMoveSet(picked,expected) ){ Logging::LogIt(Logging::logError) << "Picker moves " << movesToString(picked) << "instead of " << movesToString(expected) << ToString(p); return false; }
+    return true;
+}
+
+// a game line played from fen, the last position is seen from ply plies after the root
+struct RepetitionCase{
+    std::string fen;
+    std::vector<std::string> moves;
+    unsigned int ply;
+    bool isRep;
+    bool upcomingRep;
+};
+
+const RepetitionCase repetitionCases[] = {
+    {startPosition, {"g1f3","g8f6","f3g1","f6g8"}, 4, true, true}, // g1f3 goes back inside the tree
+    {startPosition, {"g1f3","g8f6"}, 2, false, false},
+    {startPosition, {"g1f3","g8f6","f3g1"}, 3, false, false}, // f6g8 goes back to the root, not yet a repetition
+    {startPosition, {"g1f3","g8f6","f3g1"}, 0, false, false},
+    {startPosition, {"g1f3","g8f6","f3g1","f6g8","g1f3","g8f6","f3g1"}, 0, true, true}, // f6g8 goes back to a repeated position before the root
+    {"3k4/8/8/8/8/8/8/1K3R2 w - - 0 1", {"f1c1","d8e8","c1c2","e8f8","c2a2","f8e8","a2a1","e8d8"}, 8, false, false}, // a1c1 is blocked by the king
+    {"3k4/8/8/8/8/8/8/5R1K w - - 0 1",  {"f1c1","d8e8","c1c2","e8f8","c2a2","f8e8","a2a1","e8d8"}, 8, false, true},  // a1c1 goes back inside the tree
+};
+
+// repetition detection (isRep) and upcoming repetition (cuckoo) on game lines, the search stack is filled as pvs does
+int repetitionTest(){
+    Searcher & context = ThreadPool::instance().main();
+    for (const auto & t : repetitionCases){
+        Position p;
+        readFEN(t.fen,p,true,true);
+        for (int k = 0; k < p.halfmoves; ++k){ context.stack[k].h = nullHash; context.stack[k].lastMove = INVALIDMOVE; }
+        context.stack[p.halfmoves].h = computeHash(p);
+        context.stack[p.halfmoves].lastMove = INVALIDMOVE;
+        for (const auto & ms : t.moves){
+            Square from = INVALIDSQUARE, to = INVALIDSQUARE;
+            MType mtype = T_std;
+            const Move m = readMove(p,ms,from,to,mtype) ? ToMove(from,to,mtype) : INVALIDMOVE;
+            if ( m == INVALIDMOVE || !apply(p,m) ){ Logging::LogIt(Logging::logError) << "Repetition test, cannot play " << ms << ToString(p); return 1; }
+            context.stack[p.halfmoves].h = computeHash(p);
+            context.stack[p.halfmoves].lastMove = m;
+        }
+        const bool isRep = context.isRep(p,false);
+        const bool upcomingRep = context.hasUpcomingRep(p,t.ply);
+        if ( isRep != t.isRep || upcomingRep != t.upcomingRep ){
+            Logging::LogIt(Logging::logError) << "Repetition test, isRep " << isRep << " upcoming " << upcomingRep << " instead of " << t.isRep << " " << t.upcomingRep << " at ply " << t.ply << ToString(p);
+            return 1;
+        }
+    }
+    Logging::LogIt(Logging::logInfo) << "Repetition test ok (" << sizeof(repetitionCases)/sizeof(RepetitionCase) << " lines)";
+    return 0;
+}
+}
+
 void analyze(const Position & p, DepthType depth){
         Move bestMove = INVALIDMOVE;
         ScoreType s = 0;
@@ -75,14 +285,13 @@ void analyze(const Position & p, DepthType depth){
         TimeMan::msecInTC        = -1;
         TimeMan::msecInc         = -1;
         TimeMan::msecUntilNextTC = -1;
-        Searcher::currentMoveMs = TimeMan::GetNextMSecPerMove(p);
+        Searcher::currentMoveMs = TimeMan::GetNextMSecPerMove(p, false);
         DepthType seldepth = 0;
         PVList pv;
         ThreadData d = {depth,seldepth/*dummy*/,s/*dummy*/,p,bestMove/*dummy*/,pv/*dummy*/}; // only input coef
-        ThreadPool::instance().search(d);
-        bestMove = ThreadPool::instance().main().getData().best; // here output results
-        s = ThreadPool::instance().main().getData().sc; // here output results
-        pv = ThreadPool::instance().main().getData().pv; // here output results
+        bestMove = ThreadPool::instance().search(d); // here output results
+        s = ThreadPool::instance().result().sc;
+        pv = ThreadPool::instance().result().pv;
         Logging::LogIt(Logging::logInfo) << "Best move is " << ToString(bestMove) << " " << (int)depth << " " << s << " pv : " << ToString(pv);
         Logging::LogIt(Logging::logInfo) << "Next two lines are for OpenBench";
         const TimeType ms = std::max(1,(int)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - TimeMan::startTime).count());
@@ -91,6 +300,113 @@ void analyze(const Position & p, DepthType depth){
         std::cerr << int(nodeCount/(ms/1000.f)) << std::endl;
 }
 
+namespace{
+const std::string smpBenchPositions[] = {
+    startPosition,
+    shirov,
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "2rq1rk1/pp1bppbp/2np1np1/8/3NP3/1BN1BP2/PPPQ2PP/2KR3R b - - 8 11",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+struct SMPBenchRun{ double ms, nodes, hashFull; };
+
+double mean(const std::vector<double> & v){ double s = 0; for (double x : v) s += x; return v.empty() ? 0 : s/v.size(); }
+double stdDev(const std::vector<double> & v){ const double m = mean(v); double s = 0; for (double x : v) s += (x-m)*(x-m); return v.size() < 2 ? 0 : std::sqrt(s/(v.size()-1)); }
+}
+
+// fixed depth search of all bench positions for 1, 2, 4, ... maxThreads threads, repeated runs times
+// the report goes to outFile (JSON if its extension is .json, CSV otherwise) or as CSV to stderr if outFile is empty
+void smpBench(unsigned int maxThreads, DepthType depth, unsigned int runs, const std::string & outFile){
+    maxThreads = std::max(1u, std::min(maxThreads, std::max(1u, std::thread::hardware_concurrency())));
+    runs = std::max(1u, runs);
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int n = 1 ; n < maxThreads ; n *= 2) threadCounts.push_back(n);
+    threadCounts.push_back(maxThreads);
+    std::vector<std::vector<SMPBenchRun> > results;
+    for (unsigned int n : threadCounts){
+        DynamicConfig::threads = n;
+        ThreadPool::instance().setup();
+        results.push_back(std::vector<SMPBenchRun>());
+        for (unsigned int r = 0 ; r < runs ; ++r){
+            SMPBenchRun run = {0,0,0};
+            for (const std::string & fen : smpBenchPositions){
+                Position p;
+                if ( !readFEN(fen,p,true) ) continue;
+                TT::clearTT(); // each position is searched from scratch so that runs can be compared
+                TimeMan::isDynamic       = false;
+                TimeMan::nbMoveInTC      = -1;
+                TimeMan::msecPerMove     = INFINITETIME;
+                TimeMan::msecInTC        = -1;
+                TimeMan::msecInc         = -1;
+                TimeMan::msecUntilNextTC = -1;
+                Searcher::currentMoveMs = TimeMan::GetNextMSecPerMove(p, false);
+                DepthType seldepth = 0;
+                ScoreType s = 0;
+                PVList pv;
+                ThreadData d = {depth,seldepth/*dummy*/,s/*dummy*/,p,INVALIDMOVE/*dummy*/,pv/*dummy*/};
+                const auto start = Clock::now();
+                ThreadPool::instance().search(d);
+                run.ms += std::max(1,(int)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+                run.nodes += ThreadPool::instance().counter(Stats::sid_nodes) + ThreadPool::instance().counter(Stats::sid_qnodes);
+                run.hashFull += TT::hashFull();
+            }
+            run.hashFull /= sizeof(smpBenchPositions)/sizeof(std::string);
+            Logging::LogIt(Logging::logInfo) << "smpbench threads " << n << " run " << r << " : " << run.ms << "ms " << run.nodes << " nodes";
+            results.back().push_back(run);
+        }
+    }
+
+    // speedups are given against the mean of the single thread runs
+    std::vector<double> t1, n1, nps1;
+    for (const auto & run : results[0]){ t1.push_back(run.ms); n1.push_back(run.nodes); nps1.push_back(run.nodes*1000./run.ms); }
+    const bool json = outFile.size() > 5 && outFile.substr(outFile.size()-5) == ".json";
+    std::stringstream str;
+    if ( json ) str << "{\"depth\": " << (int)depth << ", \"runs\": " << runs << ", \"smpMode\": " << DynamicConfig::smpMode << ", \"results\": [";
+    else str << "threads,depth,runs,smpMode,timeMs,timeMsSd,nps,npsSd,npsSpeedup,npsSpeedupSd,ttdSpeedup,ttdSpeedupSd,nodeOverhead,nodeOverheadSd,hashFull" << std::endl;
+    for (size_t k = 0 ; k < threadCounts.size() ; ++k){
+        std::vector<double> t, nps, npsSpeedup, ttdSpeedup, nodeOverhead, hashFull;
+        for (const auto & run : results[k]){
+            t.push_back(run.ms);
+            nps.push_back(run.nodes*1000./run.ms);
+            npsSpeedup.push_back(nps.back()/mean(nps1));
+            ttdSpeedup.push_back(mean(t1)/run.ms);
+            nodeOverhead.push_back(run.nodes/mean(n1)); // search overhead : nodes needed to reach the same depth, relative to 1 thread (not a measure of duplicated nodes)
+            hashFull.push_back(run.hashFull);
+        }
+        if ( json ){
+            str << (k ? ", " : "") << "{\"threads\": " << threadCounts[k]
+                << ", \"timeMs\": " << mean(t) << ", \"timeMsSd\": " << stdDev(t)
+                << ", \"nps\": " << mean(nps) << ", \"npsSd\": " << stdDev(nps)
+                << ", \"npsSpeedup\": " << mean(npsSpeedup) << ", \"npsSpeedupSd\": " << stdDev(npsSpeedup)
+                << ", \"ttdSpeedup\": " << mean(ttdSpeedup) << ", \"ttdSpeedupSd\": " << stdDev(ttdSpeedup)
+                << ", \"nodeOverhead\": " << mean(nodeOverhead) << ", \"nodeOverheadSd\": " << stdDev(nodeOverhead)
+                << ", \"hashFull\": " << mean(hashFull) << "}";
+        }
+        else{
+            str << threadCounts[k] << "," << (int)depth << "," << runs << "," << DynamicConfig::smpMode << ","
+                << mean(t) << "," << stdDev(t) << "," << mean(nps) << "," << stdDev(nps) << ","
+                << mean(npsSpeedup) << "," << stdDev(npsSpeedup) << "," << mean(ttdSpeedup) << "," << stdDev(ttdSpeedup) << ","
+                << mean(nodeOverhead) << "," << stdDev(nodeOverhead) << "," << mean(hashFull) << std::endl;
+        }
+    }
+    if ( json ) str << "]}" << std::endl;
+
+    if ( !outFile.empty() ){
+        std::ofstream out(outFile);
+        out << str.str() << std::flush; // fails if the file cannot be opened
+        if ( out.good() ){
+            Logging::LogIt(Logging::logInfo) << "smpbench report written to " << outFile;
+            return;
+        }
+        Logging::LogIt(Logging::logError) << "Cannot write " << outFile << ", report is given on stderr";
+    }
+    std::cerr << str.str();
+}
+
 int cliManagement(std::string cli, int argc, char ** argv){
 
     // first we parse options that do not need extra parameters
@@ -122,6 +438,23 @@ int cliManagement(std::string cli, int argc, char ** argv){
         return 0;
     }
 
+    if ( cli == "-legal_test" ) return selfTest("Legal move generator test", checkLegal);
+
+    if ( cli == "-makeunmake_test" ){
+#ifdef WITH_MAKE_UNMAKE
+        return selfTest("Make/unmake test", checkMakeUnmake);
+#else
+        Logging::LogIt(Logging::logWarn) << "Make/unmake test needs WITH_MAKE_UNMAKE";
+        return 1;
+#endif
+    }
+
+    if ( cli == "-keyafter_test" ) return selfTest("Key after test", checkKeyAfter);
+
+    if ( cli == "-repetition_test" ) return repetitionTest();
+
+    if ( cli == "-picker_test" ) return selfTest("Move picker test", checkPicker);
+
     if ( cli == "-perft_test_long_fisher" ){
         std::ifstream infile("TestSuite/fischer.txt");
         std::string line;
@@ -261,6 +594,14 @@ int cliManagement(std::string cli, int argc, char ** argv){
         return 0;
     }
 
+    if ( cli == "-smpbench" ){
+        const unsigned int maxThreads = argc > 2 ? atoi(argv[2]) : std::thread::hardware_concurrency();
+        const DepthType d             = argc > 3 ? atoi(argv[3]) : 14;
+        const unsigned int runs       = argc > 4 ? atoi(argv[4]) : 3;
+        smpBench(maxThreads, d, runs, argc > 5 ? argv[5] : "");
+        return 0;
+    }
+
     // next option needs at least one argument more
     if ( argc < 3 ){
         help();
@@ -15,7 +15,14 @@
  * -perft_test_long_fisher : run a long perf test for FRC
  * -perft_test_long : run a long perf test
  * -see_test : run a SEE test (position talen from Vajolet by Marco Belli a.k.a elcabesa)
+ * -legal_test : check the legal (and evasion) move generator against pseudo-legal generation and apply, on the perft test trees
+ * -makeunmake_test : check make/unmake against copy/make, on the perft test trees (WITH_MAKE_UNMAKE only)
+ * -keyafter_test : check keyAfter and pawnKeyAfter against apply and keys computed from scratch, on the perft test trees
+ * -repetition_test : check repetition and upcoming repetition (cuckoo) detection on some game lines
+ * -picker_test : check that the staged move picker gives each legal move once, on the perft test trees
  * bench : used for OpenBench ( by Andrew Grant)
+ * -smpbench [maxThreads] [depth] [runs] [file] : SMP scaling report (nps and time to depth speedups, search overhead, hashfull)
+ *            for 1, 2, 4, ... maxThreads threads, as CSV on stderr or in file (JSON if file ends with .json)
  * -buildBook : convert ascii book to binary book
  * -qsearch : run a qsearch
  * -see : run a SEE
@@ -16,13 +16,79 @@ namespace COM {
     SideToMove stm; ///@todo isn't this redundant with position.c ??
     Position initialPos;
     std::vector<Move> moves;
-    std::future<void> f;
+    std::vector<Hash> history;
+
+    namespace{
+        // never destroyed, the threads using them are detached and may outlive static destruction
+        struct InputQueue{
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::deque<std::string> lines;
+        };
+        InputQueue & inputQueue(){ static InputQueue * q = new InputQueue; return *q; }
+
+        struct SearchController{
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::function<void()> job;
+            bool busy = false;
+        };
+        SearchController & controller(){ static SearchController * c = new SearchController; return *c; }
+
+        std::atomic<bool> waitingFirstInfo(false), waitingBestMove(false);
+        std::chrono::time_point<Clock> goTime, stopTime;
+
+        inline double elapsedMs(const std::chrono::time_point<Clock> & t){ return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t).count()/1000.; }
+
+        void startInputReader(){
+            static bool started = false;
+            if ( started ) return;
+            started = true;
+            std::thread([]{
+                std::string line;
+                InputQueue & q = inputQueue();
+                while (std::getline(std::cin, line)){
+                    std::lock_guard<std::mutex> lock(q.mutex);
+                    q.lines.push_back(line);
+                    q.cv.notify_one();
+                }
+                std::lock_guard<std::mutex> lock(q.mutex);
+                q.lines.push_back("quit"); // end of input
+                q.cv.notify_one();
+            }).detach();
+        }
+
+        void startSearchController(){
+            static bool started = false;
+            if ( started ) return;
+            started = true;
+            std::thread([]{
+                SearchController & c = controller();
+                while (true){
+                    std::function<void()> job;
+                    {
+                        std::unique_lock<std::mutex> lock(c.mutex);
+                        c.cv.wait(lock, [&c]{ return bool(c.job); });
+                        job = c.job;
+                    }
+                    job();
+                    {
+                        std::lock_guard<std::mutex> lock(c.mutex);
+                        c.job = nullptr;
+                        c.busy = false;
+                    }
+                    c.cv.notify_all();
+                }
+            }).detach();
+        }
+    }
 
     void newgame() {
         mode = m_force;
         stm = stm_white;
         readFEN(startPosition, COM::position);
         TT::clearTT();
+        ThreadPool::instance().clearGame();
         //clearPawnTT(); ///@todo loop context
     }
 
@@ -37,17 +103,32 @@ namespace COM {
     }
 
     void readLine() {
-        command.clear();
-        std::getline(std::cin, command);
+        startInputReader();
+        InputQueue & q = inputQueue();
+        std::unique_lock<std::mutex> lock(q.mutex);
+        q.cv.wait(lock, [&q]{ return !q.lines.empty(); });
+        command = q.lines.front();
+        q.lines.pop_front();
         Logging::LogIt(Logging::logInfo) << "Received command : " << command;
     }
 
+    void wait() {
+        SearchController & c = controller();
+        std::unique_lock<std::mutex> lock(c.mutex);
+        c.cv.wait(lock, [&c]{ return !c.busy; });
+    }
+
+    void firstInfoSent() {
+        if ( waitingFirstInfo.exchange(false) ) Logging::LogIt(Logging::logInfo) << "Latency from go to first info " << elapsedMs(goTime) << "ms";
+    }
+
     SideToMove opponent(SideToMove & s) {
         return s == stm_white ? stm_black : stm_white;
     }
 
     bool sideToMoveFromFEN(const std::string & fen) {
         const bool b = readFEN(fen, COM::position,true);
+        history.clear();
         stm = COM::position.c == Co_White ? stm_white : stm_black;
         if (!b) Logging::LogIt(Logging::logFatal) << "Illegal FEN " << fen;
         return b;
@@ -59,20 +140,21 @@ namespace COM {
         Move m = INVALIDMOVE;
         if (depth < 0) depth = MAX_DEPTH;
         Logging::LogIt(Logging::logInfo) << "depth          " << (int)depth;
-        Searcher::currentMoveMs = forcedMs <= 0 ? TimeMan::GetNextMSecPerMove(position) : forcedMs;
+        Searcher::currentMoveMs = forcedMs <= 0 ? TimeMan::GetNextMSecPerMove(position, TimeMan::isUCIPondering) : forcedMs;
         Logging::LogIt(Logging::logInfo) << "currentMoveMs  " << Searcher::currentMoveMs;
         Logging::LogIt(Logging::logInfo) << ToString(position);
         DepthType seldepth = 0;
         PVList pv;
-        const ThreadData d = { depth,seldepth/*dummy*/,score/*dummy*/,position,m/*dummy*/,pv/*dummy*/ };
-        ThreadPool::instance().search(d);
-        m = ThreadPool::instance().main().getData().best; // here output results
+        const ThreadData d = { depth,seldepth/*dummy*/,score/*dummy*/,position,m/*dummy*/,pv/*dummy*/,history };
+        m = ThreadPool::instance().search(d); // here output results
         Logging::LogIt(Logging::logInfo) << "...done returning move " << ToString(m) << " (state " << COM::state << ")";;
         return m;
     }
 
     bool makeMove(Move m, bool disp, std::string tag, Move ponder) {
+        const Hash h = position.h;
         bool b = apply(position, m, true);
+        if ( b ) history.push_back(h);
         if (disp && m != INVALIDMOVE) Logging::LogIt(Logging::logGUI) << tag << " " << ToString(m) << (Logging::ct==Logging::CT_uci && VALIDMOVE(ponder) ? (" ponder " + ToString(ponder)) : "");
         Logging::LogIt(Logging::logInfo) << ToString(position);
         return b;
@@ -80,12 +162,23 @@ namespace COM {
 
     void stop() {
         Logging::LogIt(Logging::logInfo) << "stopping previous search";
+        stopTime = Clock::now();
+        waitingBestMove = true;
         Searcher::stopFlag = true;
-        if ( f.valid() ){
-           Logging::LogIt(Logging::logInfo) << "wait for future to land ...";
-           f.wait(); // synchronous wait of current future
-           Logging::LogIt(Logging::logInfo) << "...ok future is terminated";
+        endPondering();
+        Logging::LogIt(Logging::logInfo) << "wait for search to end ...";
+        wait();
+        waitingBestMove = false;
+        Logging::LogIt(Logging::logInfo) << "...ok search is terminated";
+    }
+
+    void endPondering() {
+        SearchController & c = controller();
+        {
+            std::lock_guard<std::mutex> lock(c.mutex); // the search controller may be waiting for this
+            TimeMan::isUCIPondering = false;
         }
+        c.cv.notify_all();
     }
 
     void stopPonder() {
@@ -94,10 +187,22 @@ namespace COM {
         }
     }
 
-    void thinkAsync(State st, TimeType forcedMs) { // fork a future that runs a synchorous search, if needed send returned move to GUI
-        f = std::async(std::launch::async, [st,forcedMs] {
+    void thinkAsync(State st, TimeType forcedMs) { // give a synchronous search to the search controller thread, if needed send returned move to GUI
+        startSearchController();
+        wait(); // previous search shall be done
+        goTime = Clock::now();
+        waitingFirstInfo = true;
+        SearchController & c = controller();
+        std::unique_lock<std::mutex> lock(c.mutex);
+        c.busy = true;
+        c.job = [st,forcedMs] {
             COM::move = COM::thinkUntilTimeUp(forcedMs);
-            const PVList & pv = ThreadPool::instance().main().getData().pv;
+            { // best move cannot be given while pondering (or in infinite mode), wait for ponderhit or stop
+                SearchController & c = controller();
+                std::unique_lock<std::mutex> lock(c.mutex);
+                c.cv.wait(lock, []{ return !TimeMan::isUCIPondering; });
+            }
+            const PVList & pv = ThreadPool::instance().result().pv;
             COM::ponderMove = INVALIDMOVE;
             if ( pv.size() > 1) {
                Position p2 = COM::position;
@@ -108,7 +213,9 @@ namespace COM {
                 Logging::LogIt(Logging::logInfo) << "sending move to GUI " << ToString(COM::move);
                 if (COM::move == INVALIDMOVE) { COM::mode = COM::m_force; } // game ends
                 else {
-                    if (!COM::makeMove(COM::move, true, Logging::ct == Logging::CT_uci ? "bestmove" : "move", COM::ponderMove)) {
+                    const bool b = COM::makeMove(COM::move, true, Logging::ct == Logging::CT_uci ? "bestmove" : "move", COM::ponderMove);
+                    if ( waitingBestMove.exchange(false) ) Logging::LogIt(Logging::logInfo) << "Latency from stop to best move " << elapsedMs(stopTime) << "ms";
+                    if (!b) {
                         Logging::LogIt(Logging::logGUI) << "info string Bad computer move !";
                         Logging::LogIt(Logging::logInfo) << ToString(COM::position);
                         COM::mode = COM::m_force;
@@ -121,7 +228,9 @@ namespace COM {
             }
             Logging::LogIt(Logging::logInfo) << "Putting state to none (state " << st << ")";
             state = st_none;
-        });
+        };
+        lock.unlock();
+        c.cv.notify_all();
     }
 
     Move moveFromCOM(std::string mstr) { // copy string on purpose
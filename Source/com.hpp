@@ -7,6 +7,10 @@
 /* Common tools for communication protocol (UCI and XBOARD)
  * Initialy made only for XBOARD some things here are not used in UCI...
  * ///@todo to be cleaned
+ *
+ * Input is read by a dedicated thread feeding a command queue, and searches are run one at a time
+ * by a persistent search controller thread, so that the protocol loop stays responsive during a search.
+ * Latencies from "go" to the first info and from "stop" to the best move are logged.
  */
 
 namespace COM {
@@ -26,11 +30,15 @@ namespace COM {
     extern SideToMove stm; ///@todo isn't this redundant with position.c ??
     extern Position initialPos;
     extern std::vector<Move> moves;
-    extern std::future<void> f;
+    extern std::vector<Hash> history; // hashes of the positions played before COM::position, for repetition detection
 
     void init();
 
-    void readLine();
+    void readLine(); // wait for the next command in the input queue
+
+    void wait(); // wait for the current search to be done
+
+    void firstInfoSent(); // latency measurement, called when search information is displayed
 
     SideToMove opponent(SideToMove & s);
 
@@ -40,6 +48,8 @@ namespace COM {
 
     void stop();
 
+    void endPondering(); // on ponderhit or stop, a pondering search is then allowed to give its move
+
     void stopPonder();
 
     void thinkAsync(State st, TimeType forcedMs = -1);
@@ -2,3 +2,16 @@
 
 ScoreType   Values[13]        = { -8000, -1103, -538, -393, -359, -85, 0, 85, 359, 393, 538, 1103, 8000 };
 ScoreType   ValuesEG[13]      = { -8000, -1076, -518, -301, -290, -93, 0, 93, 290, 301, 518, 1076, 8000 };
+
+#ifdef DEBUG_HEAP
+thread_local Counter heapAllocCount = 0;
+
+void * operator new(size_t size){
+    ++heapAllocCount;
+    void * ptr = malloc(size);
+    if ( !ptr ) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void * ptr) noexcept { free(ptr); }
+#endif
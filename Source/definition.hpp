@@ -12,6 +12,7 @@
 #include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <future>
@@ -45,6 +46,7 @@ const std::string MinicVersion = "2.00";
 #define WITH_XBOARD
 #define WITH_MAGIC
 #define WITH_SYZYGY
+//#define WITH_MAKE_UNMAKE // make/unmake (with an undo record) instead of copy/make in pvs, qsearch, probcut and perft
 
 // *** Add-ons
 //#define IMPORTBOOK
@@ -61,12 +63,14 @@ const std::string MinicVersion = "2.00";
 //#define DEBUG_HASH
 //#define DEBUG_PHASH
 //#define DEBUG_MATERIAL
+//#define DEBUG_PSQT // check incremental PST against a full recompute in eval
 //#define DEBUG_APPLY
 //#define DEBUG_PSEUDO_LEGAL
 //#define DEBUG_HASH_ENTRY
 //#define DEBUG_KING_CAP
 //#define DEBUG_ACC ///@todo make this work again !!
 //#define DEBUG_PERFT
+//#define DEBUG_HEAP // count heap allocations and check that none is done inside the search tree
 
 #ifdef WITH_TEXEL_TUNING
 #define CONST_TEXEL_TUNING
@@ -93,6 +97,8 @@ const std::string MinicVersion = "2.00";
 #define MAX_PLY      1024
 #define MAX_MOVE      256   // 256 is enough I guess/hope ...
 #define MAX_DEPTH     127   // if DepthType is a char, !!!do not go above 127!!!
+#define MAX_SKIPMOVE  16    // multiPV moves or singular move
+#define MAX_DEFERRED  16    // ABDADA deferred moves per node, more are searched right away
 #define MAX_HISTORY  1000
 
 #define SQFILE(s) ((s)&7)
@@ -113,7 +119,7 @@ const std::string MinicVersion = "2.00";
 #define JOIN(symbol1,symbol2) _DO_JOIN(symbol1,symbol2 )
 #define _DO_JOIN(symbol1,symbol2) symbol1##symbol2
 
-typedef std::chrono::system_clock Clock;
+typedef std::chrono::steady_clock Clock; // monotonic, wall clock is only used for log dates
 typedef signed char DepthType;
 typedef int32_t Move;         // invalid if < 0
 typedef int16_t MiniMove;     // invalid if < 0
@@ -132,9 +138,39 @@ const BitBoard empty = 0ull;
 enum GamePhase { MG=0, EG=1, GP_MAX=2 };
 inline GamePhase operator++(GamePhase & g){g=GamePhase(g+1); return g;}
 
-template < typename T, int SIZE > struct OptList : public std::vector<T>{ OptList() : std::vector<T>(){std::vector<T>::reserve(SIZE);}};
+// fixed capacity list, living where it is declared (no heap allocation), only the used part is copied
+template < typename T, int SIZE > struct OptList{
+    typedef T value_type;
+    typedef T * iterator;
+    typedef const T * const_iterator;
+    OptList():_n(0){}
+    OptList(const OptList & l):_n(l._n){ std::copy(l.begin(), l.end(), begin()); }
+    OptList & operator=(const OptList & l){ _n = l._n; std::copy(l.begin(), l.end(), begin()); return *this; }
+    inline void push_back(const T & t){ assert(_n < (size_t)SIZE); _data[_n++] = t; }
+    inline void pop_back(){ assert(_n > 0); --_n; }
+    inline void clear(){ _n = 0; }
+    inline void resize(size_t n){ assert(n <= _n); _n = n; } // shrink only
+    inline size_t size()const{ return _n; }
+    inline bool empty()const{ return _n == 0; }
+    inline T & operator[](size_t k){ assert(k < _n); return _data[k]; }
+    inline const T & operator[](size_t k)const{ assert(k < _n); return _data[k]; }
+    inline T & back(){ assert(_n > 0); return _data[_n-1]; }
+    inline iterator begin(){ return &_data[0]; }
+    inline iterator end(){ return &_data[0] + _n; }
+    inline const_iterator begin()const{ return &_data[0]; }
+    inline const_iterator end()const{ return &_data[0] + _n; }
+private:
+    T _data[SIZE];
+    size_t _n;
+};
 typedef OptList<Move,MAX_MOVE> MoveList;
-typedef std::vector<Move> PVList;
+typedef OptList<Move,MAX_DEPTH+1> PVList;
+typedef OptList<MiniMove,MAX_SKIPMOVE> SkipList;
+typedef OptList<Move,MAX_DEFERRED> DeferredList;
+
+#ifdef DEBUG_HEAP
+extern thread_local Counter heapAllocCount; // number of heap allocations done by the current thread
+#endif
 
 inline MiniHash Hash64to32   (Hash h) { return (h >> 32) & 0xFFFFFFFF; }
 inline MiniMove Move2MiniMove(Move m) { return m & 0xFFFF;} // skip score
@@ -218,7 +254,7 @@ inline Color operator++(Color & c){c=Color(c+1); return c;}
 const ScoreType MoveScoring[16] = { 0, 7000, 7100, 6000, 3950, 3500, 3350, 3300, 7950, 7500, 7350, 7300, 200, 200, 200, 200 };
 
 inline bool sameMove  (const Move & a, const Move & b) { return Move2MiniMove(a) == Move2MiniMove(b);}
-inline bool isSkipMove(const Move & a, const std::vector<MiniMove> * skipMoves){ return skipMoves && std::find(skipMoves->begin(), skipMoves->end(), Move2MiniMove(a)) != skipMoves->end();}
+inline bool isSkipMove(const Move & a, const SkipList * skipMoves){ return skipMoves && std::find(skipMoves->begin(), skipMoves->end(), Move2MiniMove(a)) != skipMoves->end();}
 
 inline ScoreType Move2Score(Move m) { assert(VALIDMOVE(m)); return (m >> 16) & 0xFFFF; }
 inline Square    Move2From (Move m) { assert(VALIDMOVE(m)); return (m >> 10) & 0x3F  ; }
@@ -254,7 +290,8 @@ namespace MoveDifficultyUtil {
 }
 
 inline void updatePV(PVList & pv, const Move & m, const PVList & childPV) {
+    assert(&pv != &childPV);
     pv.clear();
     pv.push_back(m);
-    std::copy(childPV.begin(), childPV.end(), std::back_inserter(pv));
+    for (size_t k = 0 ; k < childPV.size() && pv.size() < MAX_DEPTH+1 ; ++k) pv.push_back(childPV[k]);
 }
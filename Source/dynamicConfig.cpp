@@ -4,6 +4,12 @@ namespace DynamicConfig{
     bool mateFinder        = false;
     bool disableTT         = false;
     unsigned int ttSizeMb  = 128; // here in Mb, will be converted to real size next
+    bool largePages        = true;  // use huge pages for big tables if the system allows it
+    bool numaInterleave    = false; // TT pages interleaved over NUMA nodes instead of first-touch
+    std::string ttSharedName = "";  // name of the shared memory segment holding the TT, private TT if empty
+    unsigned int ttPawnSizeMb = 4;  // pawn table size per thread in Mb
+    bool sharedPawnTable   = false; // a single pawn table (of ttPawnSizeMb per thread) shared by all threads
+    bool ttTelemetry       = false; // TT statistics by draft, dumped at the end of each search (needs quiet off to be seen)
     bool fullXboardOutput  = false;
     bool debugMode         = false;
     bool quiet             = true;
@@ -12,8 +18,11 @@ namespace DynamicConfig{
     bool book              = false;
     std::string bookFile   = "book.bin";
     unsigned int threads   = 1;
+    bool threadAffinity    = false; // pin each search thread to a core (physical cores first, spread over NUMA nodes)
+    unsigned int smpMode   = smp_lazy; // lazy SMP with depth skipping, or ABDADA like deferred moves
     std::string syzygyPath = "";
     bool FRC               = false;
     bool UCIPonder         = false;
     unsigned int multiPV   = 1;
+    bool historyAging      = false; // history tables are halved between searches of the same game instead of being cleared
 }
@@ -9,6 +9,12 @@ namespace DynamicConfig{
     extern bool mateFinder       ;
     extern bool disableTT        ;
     extern unsigned int ttSizeMb ;
+    extern bool largePages       ;
+    extern bool numaInterleave   ;
+    extern std::string ttSharedName;
+    extern unsigned int ttPawnSizeMb;
+    extern bool sharedPawnTable  ;
+    extern bool ttTelemetry      ;
     extern bool fullXboardOutput ;
     extern bool debugMode        ;
     extern bool quiet            ;
@@ -17,8 +23,12 @@ namespace DynamicConfig{
     extern bool book             ;
     extern std::string bookFile  ;
     extern unsigned int threads  ;
+    extern bool threadAffinity   ;
+    enum SMPMode : unsigned char { smp_lazy = 0, smp_abdada = 1 };
+    extern unsigned int smpMode  ;
     extern std::string syzygyPath;
     extern bool FRC              ;
     extern bool UCIPonder        ;
     extern unsigned int multiPV  ;
+    extern bool historyAging     ;
 }
@@ -26,19 +26,17 @@ namespace{ // some Color / Piece helpers
 }
 
 template < Piece T , Color C>
-inline void evalPiece(const Position & p, BitBoard pieceBBiterator, const BitBoard (& kingZone)[2], EvalScore & score, BitBoard & attBy, BitBoard & att, BitBoard & att2, ScoreType (& kdanger)[2], BitBoard & checkers){
+inline void evalPiece(const Position & p, BitBoard pieceBBiterator, const BitBoard (& kingZone)[2], BitBoard & attBy, BitBoard & att, BitBoard & att2, ScoreType (& kdanger)[2], BitBoard & checkers){
     while (pieceBBiterator) {
         const Square k = popBit(pieceBBiterator);
-        const Square kk = ColorSquarePstHelper<C>(k);
-        score += EvalConfig::PST[T-1][kk] * ColorSignHelper<C>();
-        const BitBoard target = BBTools::pfCoverage[T-1](k, p.occupancy, C); // real targets
+        const BitBoard target = BBTools::coverage<T>(k, p.occupancy, C); // real targets
         if ( target ){
            attBy |= target;
            att2  |= att & target;
            att   |= target;
            if ( target & p.pieces<P_wk>(~C) ) checkers |= SquareToBitboard(k);
         }
-        const BitBoard shadowTarget = BBTools::pfCoverage[T-1](k, p.occupancy ^ /*p.pieces<T>(C)*/ alignedThreatPieceSlider<T>(p,C), C); // aligned threats of same piece type also taken into account and knight in front also removed ///@todo better?
+        const BitBoard shadowTarget = BBTools::coverage<T>(k, p.occupancy ^ /*p.pieces<T>(C)*/ alignedThreatPieceSlider<T>(p,C), C); // aligned threats of same piece type also taken into account and knight in front also removed ///@todo better?
         if ( shadowTarget ){
            kdanger[C]  -= countBit(shadowTarget & kingZone[C])  * EvalConfig::kingAttWeight[EvalConfig::katt_defence][T-1];
            kdanger[~C] += countBit(shadowTarget & kingZone[~C]) * EvalConfig::kingAttWeight[EvalConfig::katt_attack][T-1];
@@ -50,7 +48,7 @@ inline void evalPiece(const Position & p, BitBoard pieceBBiterator, const BitBoa
 template < Piece T ,Color C>
 inline void evalMob(const Position & p, BitBoard pieceBBiterator, ScoreAcc & score, const BitBoard safe){
     while (pieceBBiterator){
-        const BitBoard mob = BBTools::pfCoverage[T-1](popBit(pieceBBiterator), p.occupancy, C) & ~p.allPieces[C] & safe;
+        const BitBoard mob = BBTools::coverage<T>(popBit(pieceBBiterator), p.occupancy, C) & ~p.allPieces[C] & safe;
         score[sc_MOB] += EvalConfig::MOB[T-2][countBit(mob)]*ColorSignHelper<C>();
     }
 }
@@ -59,9 +57,9 @@ template < Color C >
 inline void evalMobQ(const Position & p, BitBoard pieceBBiterator, ScoreAcc & score, const BitBoard safe){
     while (pieceBBiterator){
         const Square s = popBit(pieceBBiterator);
-        BitBoard mob = BBTools::pfCoverage[P_wb-1](s, p.occupancy, C) & ~p.allPieces[C] & safe;
+        BitBoard mob = BBTools::coverage<P_wb>(s, p.occupancy, C) & ~p.allPieces[C] & safe;
         score[sc_MOB] += EvalConfig::MOB[3][countBit(mob)]*ColorSignHelper<C>();
-        mob = BBTools::pfCoverage[P_wr-1](s, p.occupancy, C) & ~p.allPieces[C] & safe;
+        mob = BBTools::coverage<P_wr>(s, p.occupancy, C) & ~p.allPieces[C] & safe;
         score[sc_MOB] += EvalConfig::MOB[4][countBit(mob)]*ColorSignHelper<C>();
     }
 }
@@ -69,7 +67,7 @@ inline void evalMobQ(const Position & p, BitBoard pieceBBiterator, ScoreAcc & sc
 template < Color C>
 inline void evalMobK(const Position & p, BitBoard pieceBBiterator, ScoreAcc & score, const BitBoard safe){
     while (pieceBBiterator){
-        const BitBoard mob = BBTools::pfCoverage[P_wk-1](popBit(pieceBBiterator), p.occupancy, C) & ~p.allPieces[C] & safe;
+        const BitBoard mob = BBTools::coverage<P_wk>(popBit(pieceBBiterator), p.occupancy, C) & ~p.allPieces[C] & safe;
         score[sc_MOB] += EvalConfig::MOB[5][countBit(mob)]*ColorSignHelper<C>();
     }
 }
@@ -78,18 +76,13 @@ template< Color C>
 inline void evalPawnPasser(const Position & p, BitBoard pieceBBiterator, EvalScore & score){
     while (pieceBBiterator) {
         const Square k = popBit(pieceBBiterator);
-        const EvalScore kingNearBonus   = EvalConfig::kingNearPassedPawn * ScoreType( chebyshevDistance(p.king[~C], k) - chebyshevDistance(p.king[C], k) );
-        const bool unstoppable          = (p.mat[~C][M_t] == 0)&&((chebyshevDistance(p.king[~C],PromotionSquare<C>(k))-int(p.c!=C)) > std::min(Square(5), chebyshevDistance(PromotionSquare<C>(k),k)));
+        const EvalScore kingNearBonus   = EvalConfig::kingNearPassedPawn * ScoreType( chebyshevDistance(p.king(~C), k) - chebyshevDistance(p.king(C), k) );
+        const bool unstoppable          = (p.mat[~C][M_t] == 0)&&((chebyshevDistance(p.king(~C),PromotionSquare<C>(k))-int(p.c!=C)) > std::min(Square(5), chebyshevDistance(PromotionSquare<C>(k),k)));
         if (unstoppable) score += ColorSignHelper<C>()*(Values[P_wr+PieceShift] - Values[P_wp+PieceShift]); // yes rook not queen to force promotion asap
         else             score += (EvalConfig::passerBonus[ColorRank<C>(k)] + kingNearBonus)*ColorSignHelper<C>();
     }
 }
 
-template < Color C>
-inline void evalPawn(BitBoard pieceBBiterator, EvalScore & score){
-    while (pieceBBiterator) { score += EvalConfig::PST[0][ColorSquarePstHelper<C>(popBit(pieceBBiterator))] * ColorSignHelper<C>(); }
-}
-
 template< Color C>
 inline void evalPawnFreePasser(const Position & p, BitBoard pieceBBiterator, EvalScore & score){
     while (pieceBBiterator) {
@@ -112,7 +105,7 @@ BitBoard getPinned(const Position & p, const Square s){
     BitBoard pinned = empty;
     if ( s == INVALIDSQUARE ) return pinned;
     BitBoard pinner = BBTools::attack<P_wb>(s, p.pieces<P_wb>(~C) | p.pieces<P_wq>(~C), p.allPieces[~C]) | BBTools::attack<P_wr>(s, p.pieces<P_wr>(~C) | p.pieces<P_wq>(~C), p.allPieces[~C]);
-    while ( pinner ) { pinned |= BBTools::mask[popBit(pinner)].between[p.king[C]] & p.allPieces[C]; }
+    while ( pinner ) { pinned |= BBTools::mask[popBit(pinner)].between[p.king(C)] & p.allPieces[C]; }
     return pinned;
 }
 
@@ -125,11 +118,11 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
 
     // king captured
     const bool white2Play = p.c == Co_White;
-    if ( p.king[Co_White] == INVALIDSQUARE ){
+    if ( p.king(Co_White) == INVALIDSQUARE ){
       STOP_AND_SUM_TIMER(Eval)
       return data.gp=0,(white2Play?-1:+1)* MATE;
     }
-    if ( p.king[Co_Black] == INVALIDSQUARE ) {
+    if ( p.king(Co_Black) == INVALIDSQUARE ) {
       STOP_AND_SUM_TIMER(Eval)
       return data.gp=0,(white2Play?+1:-1)* MATE;
     }
@@ -138,7 +131,7 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
     const int lra = std::max(0, 500 - int(10*DynamicConfig::level));
     if ( lra > 0 ) { score[sc_Rand] += Zobrist::randomInt<int>(-lra,lra); }
 
-    context.prefetchPawn(computeHash(p));
+    context.prefetchPawn(computePHash(p));
 
     // Material evaluation
     const Hash matHash = MaterialHash::getMaterialHash(p.mat);
@@ -184,6 +177,17 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
     score[sc_Mat] += MaterialHash::Imbalance(p.mat, Co_White) - MaterialHash::Imbalance(p.mat, Co_Black);
 #endif
 
+    // PST (incrementally updated in apply)
+#ifdef WITH_TEXEL_TUNING
+    score[sc_PST] += computePSQT(p); // PST are being tuned
+#else
+    score[sc_PST] += p.psqt;
+#endif
+#ifdef DEBUG_PSQT
+    const EvalScore psqt = computePSQT(p);
+    if ( psqt[MG] != p.psqt[MG] || psqt[EG] != p.psqt[EG] ){ Logging::LogIt(Logging::logFatal) << "PST update error " << ToString(p) << " " << p.psqt[MG] << " " << p.psqt[EG] << " " << psqt[MG] << " " << psqt[EG]; }
+#endif
+
     // usefull bitboards accumulator
     const BitBoard pawns[2]          = {p.whitePawn(), p.blackPawn()};
     const BitBoard allPawns          = pawns[Co_White] | pawns[Co_Black];
@@ -193,20 +197,20 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
     BitBoard attFromPiece[2][6]      = {{empty}}; ///@todo use this more!
     BitBoard checkers[2][6]          = {{empty}};
 
-    const BitBoard kingZone[2]   = { BBTools::mask[p.king[Co_White]].kingZone, BBTools::mask[p.king[Co_Black]].kingZone};
-    const BitBoard kingShield[2] = { kingZone[Co_White] & ~BBTools::shiftS<Co_White>(ranks[SQRANK(p.king[Co_White])]) , kingZone[Co_Black] & ~BBTools::shiftS<Co_Black>(ranks[SQRANK(p.king[Co_Black])]) };
-
-    // PST, attack, danger
-    evalPiece<P_wn,Co_White>(p,p.pieces<P_wn>(Co_White),kingZone,score[sc_PST],attFromPiece[Co_White][P_wn-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wn-1]);
-    evalPiece<P_wb,Co_White>(p,p.pieces<P_wb>(Co_White),kingZone,score[sc_PST],attFromPiece[Co_White][P_wb-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wb-1]);
-    evalPiece<P_wr,Co_White>(p,p.pieces<P_wr>(Co_White),kingZone,score[sc_PST],attFromPiece[Co_White][P_wr-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wr-1]);
-    evalPiece<P_wq,Co_White>(p,p.pieces<P_wq>(Co_White),kingZone,score[sc_PST],attFromPiece[Co_White][P_wq-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wq-1]);
-    evalPiece<P_wk,Co_White>(p,p.pieces<P_wk>(Co_White),kingZone,score[sc_PST],attFromPiece[Co_White][P_wk-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wk-1]);
-    evalPiece<P_wn,Co_Black>(p,p.pieces<P_wn>(Co_Black),kingZone,score[sc_PST],attFromPiece[Co_Black][P_wn-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wn-1]);
-    evalPiece<P_wb,Co_Black>(p,p.pieces<P_wb>(Co_Black),kingZone,score[sc_PST],attFromPiece[Co_Black][P_wb-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wb-1]);
-    evalPiece<P_wr,Co_Black>(p,p.pieces<P_wr>(Co_Black),kingZone,score[sc_PST],attFromPiece[Co_Black][P_wr-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wr-1]);
-    evalPiece<P_wq,Co_Black>(p,p.pieces<P_wq>(Co_Black),kingZone,score[sc_PST],attFromPiece[Co_Black][P_wq-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wq-1]);
-    evalPiece<P_wk,Co_Black>(p,p.pieces<P_wk>(Co_Black),kingZone,score[sc_PST],attFromPiece[Co_Black][P_wk-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wk-1]);
+    const BitBoard kingZone[2]   = { BBTools::mask[p.king(Co_White)].kingZone, BBTools::mask[p.king(Co_Black)].kingZone};
+    const BitBoard kingShield[2] = { kingZone[Co_White] & ~BBTools::shiftS<Co_White>(ranks[SQRANK(p.king(Co_White))]) , kingZone[Co_Black] & ~BBTools::shiftS<Co_Black>(ranks[SQRANK(p.king(Co_Black))]) };
+
+    // attack, danger
+    evalPiece<P_wn,Co_White>(p,p.pieces<P_wn>(Co_White),kingZone,attFromPiece[Co_White][P_wn-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wn-1]);
+    evalPiece<P_wb,Co_White>(p,p.pieces<P_wb>(Co_White),kingZone,attFromPiece[Co_White][P_wb-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wb-1]);
+    evalPiece<P_wr,Co_White>(p,p.pieces<P_wr>(Co_White),kingZone,attFromPiece[Co_White][P_wr-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wr-1]);
+    evalPiece<P_wq,Co_White>(p,p.pieces<P_wq>(Co_White),kingZone,attFromPiece[Co_White][P_wq-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wq-1]);
+    evalPiece<P_wk,Co_White>(p,p.pieces<P_wk>(Co_White),kingZone,attFromPiece[Co_White][P_wk-1],att[Co_White],att2[Co_White],kdanger,checkers[Co_White][P_wk-1]);
+    evalPiece<P_wn,Co_Black>(p,p.pieces<P_wn>(Co_Black),kingZone,attFromPiece[Co_Black][P_wn-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wn-1]);
+    evalPiece<P_wb,Co_Black>(p,p.pieces<P_wb>(Co_Black),kingZone,attFromPiece[Co_Black][P_wb-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wb-1]);
+    evalPiece<P_wr,Co_Black>(p,p.pieces<P_wr>(Co_Black),kingZone,attFromPiece[Co_Black][P_wr-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wr-1]);
+    evalPiece<P_wq,Co_Black>(p,p.pieces<P_wq>(Co_Black),kingZone,attFromPiece[Co_Black][P_wq-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wq-1]);
+    evalPiece<P_wk,Co_Black>(p,p.pieces<P_wk>(Co_Black),kingZone,attFromPiece[Co_Black][P_wk-1],att[Co_Black],att2[Co_Black],kdanger,checkers[Co_Black][P_wk-1]);
 
     /*
 #ifndef WITH_TEXEL_TUNING
@@ -242,9 +246,6 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
        pe.holes         [Co_White] = BBTools::pawnHoles     <Co_White>(pawns[Co_White]) & holesZone[Co_White] ; pe.holes         [Co_Black] = BBTools::pawnHoles     <Co_Black>(pawns[Co_Black]) & holesZone[Co_White];
        pe.openFiles =  BBTools::openFiles(pawns[Co_White], pawns[Co_Black]);
 
-       // PST, attack
-       evalPawn<Co_White>(p.pieces<P_wp>(Co_White),pe.score);
-       evalPawn<Co_Black>(p.pieces<P_wp>(Co_Black),pe.score);
        // danger in king zone
        pe.danger[Co_White] -= countBit(pe.pawnTargets[Co_White] & kingZone[Co_White]) * EvalConfig::kingAttWeight[EvalConfig::katt_defence][0];
        pe.danger[Co_White] += countBit(pe.pawnTargets[Co_Black] & kingZone[Co_White]) * EvalConfig::kingAttWeight[EvalConfig::katt_attack] [0];
@@ -280,8 +281,8 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
        pe.score += EvalConfig::pawnShieldBonus * std::min(pawnShieldW*pawnShieldW,9);
        pe.score -= EvalConfig::pawnShieldBonus * std::min(pawnShieldB*pawnShieldB,9);
        // malus for king on a pawnless flank
-       const File wkf = (File)SQFILE(p.king[Co_White]);
-       const File bkf = (File)SQFILE(p.king[Co_Black]);
+       const File wkf = (File)SQFILE(p.king(Co_White));
+       const File bkf = (File)SQFILE(p.king(Co_Black));
        if (!(pawns[Co_White] & kingFlank[wkf])) pe.score += EvalConfig::pawnlessFlank;
        if (!(pawns[Co_Black] & kingFlank[bkf])) pe.score -= EvalConfig::pawnlessFlank;
        // pawn storm
@@ -295,8 +296,9 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
        pe.danger[Co_Black] += EvalConfig::kingAttSemiOpenfileOpp * countBit(kingFlank[bkf] & pe.semiOpenFiles[Co_Black])/8;
        pe.danger[Co_Black] += EvalConfig::kingAttSemiOpenfileOur * countBit(kingFlank[bkf] & pe.semiOpenFiles[Co_White])/8;
 
-       ++context.stats.counters[Stats::sid_ttPawnInsert];
-       pe.h = Hash64to32(computePHash(p)); // set the pawn entry
+#ifndef WITH_TEXEL_TUNING
+       context.setPawnEntry(computePHash(p), pe);
+#endif
     }
     assert(pePtr);
     const Searcher::PawnEntry & pe = *pePtr;
@@ -442,7 +444,7 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
     const Square blackQueenSquare = p.blackQueen() ? BBTools::SquareFromBitBoard(p.blackQueen()) : INVALIDSQUARE;
 
     // pins on king and queen
-    const BitBoard pinnedK [2] = { getPinned<Co_White>(p,p.king[Co_White]), getPinned<Co_Black>(p,p.king[Co_Black]) };
+    const BitBoard pinnedK [2] = { getPinned<Co_White>(p,p.king(Co_White)), getPinned<Co_Black>(p,p.king(Co_Black)) };
     const BitBoard pinnedQ [2] = { getPinned<Co_White>(p,whiteQueenSquare), getPinned<Co_Black>(p,blackQueenSquare) };
     for (Piece pp = P_wp ; pp < P_wk ; ++pp) {
         if (p.pieces(Co_White, pp)) {
@@ -456,8 +458,8 @@ inline ScoreType eval(const Position & p, EvalData & data, Searcher &context){
     }
 
     // attack : queen distance to opponent king (wrong if multiple queens ...)
-    if ( blackQueenSquare != INVALIDSQUARE ) score[sc_QueenNearKing] -= EvalConfig::queenNearKing * (7 - chebyshevDistance(p.king[Co_White], blackQueenSquare) );
-    if ( whiteQueenSquare != INVALIDSQUARE ) score[sc_QueenNearKing] += EvalConfig::queenNearKing * (7 - chebyshevDistance(p.king[Co_Black], whiteQueenSquare) );
+    if ( blackQueenSquare != INVALIDSQUARE ) score[sc_QueenNearKing] -= EvalConfig::queenNearKing * (7 - chebyshevDistance(p.king(Co_White), blackQueenSquare) );
+    if ( whiteQueenSquare != INVALIDSQUARE ) score[sc_QueenNearKing] += EvalConfig::queenNearKing * (7 - chebyshevDistance(p.king(Co_Black), whiteQueenSquare) );
 
     // number of pawn and piece type value
     score[sc_Adjust] += EvalConfig::adjRook  [p.mat[Co_White][M_p]] * ScoreType(p.mat[Co_White][M_r]);
@@ -149,7 +149,7 @@ std::string ltrim(std::string &s) {
 
 ExtendedPosition::ExtendedPosition(const std::string & extFEN, bool withMoveCount) : Position(extFEN, withMoveCount){
     if (!withMoveCount) {
-        halfmoves = 0; moves = 1; fifty = 0;
+        halfmoves = c == Co_Black ? 2 : 1; fifty = 0; // move 1
     }
     //Logging::LogIt(Logging::logInfo) << ToString(*this);
     std::vector<std::string> strList;
@@ -256,8 +256,7 @@ void ExtendedPosition::test(const std::vector<std::string> & positions,
             Move bestMove = INVALIDMOVE;
             PVList pv;
             ThreadData d = {depth,seldepth,s,extP,bestMove,pv}; // only input coef
-            ThreadPool::instance().search(d);
-            bestMove = ThreadPool::instance().main().getData().best; // here output results
+            bestMove = ThreadPool::instance().search(d); // here output results
 
             results[k][t].name = extP.id();
             results[k][t].k = (int)k;
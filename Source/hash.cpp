@@ -1,5 +1,6 @@
 #include "hash.hpp"
 
+#include "attack.hpp"
 #include "bitboardTools.hpp"
 #include "logging.hpp"
 #include "position.hpp"
@@ -13,6 +14,46 @@ namespace Zobrist {
     }
 }
 
+namespace Cuckoo {
+    Hash keys[size];
+    MiniMove moves[size];
+    void init() {
+        Logging::LogIt(Logging::logInfo) << "Init cuckoo";
+        std::fill(keys, keys + size, nullHash);
+        std::fill(moves, moves + size, INVALIDMINIMOVE);
+        const Hash colorKey = Zobrist::ZT[3][13] ^ Zobrist::ZT[4][13];
+        int count = 0;
+        for (Piece pp = P_bk; pp <= P_wk; ++pp) {
+            if ( std::abs(pp) == P_wp || pp == P_none ) continue;
+            for (Square s1 = 0; s1 < 64; ++s1) {
+                for (Square s2 = s1 + 1; s2 < 64; ++s2) {
+                    BitBoard target = empty;
+                    switch(std::abs(pp)){
+                    case P_wn: target = BBTools::coverage<P_wn>(s1, empty, Co_White); break;
+                    case P_wb: target = BBTools::coverage<P_wb>(s1, empty, Co_White); break;
+                    case P_wr: target = BBTools::coverage<P_wr>(s1, empty, Co_White); break;
+                    case P_wq: target = BBTools::coverage<P_wq>(s1, empty, Co_White); break;
+                    case P_wk: target = BBTools::coverage<P_wk>(s1, empty, Co_White); break;
+                    }
+                    if ( !(target & SquareToBitboard(s2)) ) continue;
+                    // insert, kicking out the already present move if needed (cuckoo hashing)
+                    Hash key = Zobrist::ZT[s1][pp+PieceShift] ^ Zobrist::ZT[s2][pp+PieceShift] ^ colorKey;
+                    MiniMove m = ToMove(s1, s2, T_std);
+                    int i = h1(key);
+                    while (true) {
+                        std::swap(keys[i], key);
+                        std::swap(moves[i], m);
+                        if ( m == INVALIDMINIMOVE ) break; // empty slot was found
+                        i = (i == h1(key)) ? h2(key) : h1(key); // push the kicked out move to its other slot
+                    }
+                    ++count;
+                }
+            }
+        }
+        if ( count != 3668 ) Logging::LogIt(Logging::logFatal) << "Bad cuckoo table init " << count;
+    }
+}
+
 Hash computeHash(const Position &p){
 #ifdef DEBUG_HASH
     Hash h = p.h;
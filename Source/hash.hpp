@@ -18,6 +18,17 @@ namespace Zobrist {
     void initHash();
 }
 
+// Cuckoo tables of reversible moves (non pawn piece moves on an empty board) indexed by their hash delta (color included)
+// Used to detect in O(1) that a position of the search history can be reached back in one move (upcoming repetition)
+namespace Cuckoo {
+    const int size = 8192;
+    extern Hash keys[size];
+    extern MiniMove moves[size];
+    inline int h1(const Hash h){ return int(h & 0x1fff); }
+    inline int h2(const Hash h){ return int((h >> 16) & 0x1fff); }
+    void init(); // after Zobrist and masks initialization
+}
+
 // Position hash is computed only once and then updated on the fly
 // But this encapsulating function is usefull for debugging
 Hash computeHash(const Position &p);
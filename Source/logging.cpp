@@ -11,7 +11,7 @@ namespace Logging {
 
     std::string showDate() {
         std::stringstream str;
-        auto msecEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch());
+        auto msecEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
         char buffer[64];
         auto tt = std::chrono::system_clock::to_time_t(std::chrono::system_clock::time_point(msecEpoch));
         std::strftime(buffer, 63, "%Y-%m-%d %H:%M:%S", localtime(&tt));
@@ -114,15 +114,15 @@ namespace MaterialHash { // idea from Gull
         if (p.c != winningSide ){ // stale mate detection for losing side
            ///@todo
         }
-        const Square winningK = p.king[winningSide];
-        const Square losingK  = p.king[~winningSide];
+        const Square winningK = p.king(winningSide);
+        const Square losingK  = p.king(~winningSide);
         const ScoreType sc = pushToEdges[losingK] + pushClose[chebyshevDistance(winningK,losingK)];
         return s + ((winningSide == Co_White)?(sc+WIN):(-sc-WIN));
     }
 
     ScoreType helperKmmK(const Position &p, Color winningSide, ScoreType s){
-        Square winningK = p.king[winningSide];
-        Square losingK  = p.king[~winningSide];
+        Square winningK = p.king(winningSide);
+        Square losingK  = p.king(~winningSide);
         if ( ((p.whiteBishop()|p.blackBishop()) & whiteSquare) != 0 ){
             winningK = VFlip(winningK);
             losingK  = VFlip(losingK);
@@ -298,6 +298,32 @@ namespace MaterialHash { // idea from Gull
       return materialHashTable[getMaterialHash(mat)].t;
     }
 
+    Hash getMaterialHashAfterCapture(const Position & p, const Square capSq){
+        const Hash h = getMaterialHash(p.mat);
+        if ( h == nullHash ) return nullHash;
+        const Piece pp = p.b[capSq];
+        const bool white = pp > 0;
+        switch(std::abs(pp)){
+        case P_wp: return h - (white ? MatWP : MatBP);
+        case P_wn: return h - (white ? MatWN : MatBN);
+        case P_wb: return h - ((SquareToBitboard(capSq) & whiteSquare) ? (white ? MatWL : MatBL) : (white ? MatWD : MatBD));
+        case P_wr: return h - (white ? MatWR : MatBR);
+        case P_wq: return h - (white ? MatWQ : MatBQ);
+        default:   return nullHash;
+        }
+    }
+
+    void prefetch(Hash matHash){
+        void * addr = &materialHashTable[matHash];
+#  if defined(__INTEL_COMPILER)
+        __asm__ ("");
+#  elif defined(_MSC_VER)
+        _mm_prefetch((char*)addr, _MM_HINT_T0);
+#  else
+        __builtin_prefetch(addr);
+#  endif
+    }
+
     void updateMaterialOther(Position & p){
         p.mat[Co_White][M_M] = p.mat[Co_White][M_q] + p.mat[Co_White][M_r];  
         p.mat[Co_Black][M_M] = p.mat[Co_Black][M_q] + p.mat[Co_Black][M_r];
@@ -59,6 +59,11 @@ namespace MaterialHash {
 
     Terminaison probeMaterialHashTable(const Position::Material & mat);
 
+    // key is linear in piece counts, so the key after a capture is found without updating the material (nullHash if out of table)
+    Hash getMaterialHashAfterCapture(const Position & p, const Square capSq);
+
+    void prefetch(Hash matHash);
+
     void updateMaterialOther(Position & p);
 
     void initMaterial(Position & p);
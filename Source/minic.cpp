@@ -29,17 +29,18 @@ void init(int argc, char ** argv) {
     Options::initOptions(argc, argv);
     Logging::init(); // after reading options
     Zobrist::initHash();
-    TT::initTable();
     SearchConfig::initLMR();
     SearchConfig::initMvvLva();
     BBTools::initMask();
 #ifdef WITH_MAGIC
     BBTools::MagicBB::initMagic();
 #endif
+    Cuckoo::init(); // after hash and masks
     KPK::init();
     MaterialHash::MaterialHashInitializer::init();
     EvalConfig::initEval();
     ThreadPool::instance().setup();
+    TT::initTable(); // after threads setup, as clearing is shared between them
     Book::initBook();
 #ifdef WITH_SYZYGY
     SyzygyTb::initTB(DynamicConfig::syzygyPath);
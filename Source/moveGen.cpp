@@ -13,6 +13,94 @@ void addMove(Square from, Square to, MType type, MoveList & moves) {
   moves.push_back(ToMove(from, to, type, 0));
 }
 
+namespace{
+inline bool inPhase(GenPhase phase, bool isCap){ return phase == GP_all || (phase == GP_cap) == isCap; }
+}
+
+void initLegalInfo(const Position & p, LegalInfo & li){
+    const Color side = p.c;
+    const Square k = p.king(side);
+    assert(k != INVALIDSQUARE);
+    li.checkers = BBTools::allAttackedBB(p, k, side);
+    li.pinned = empty;
+    // sliders seeing the king on an empty board, the piece is pinned if it is the only one in between
+    BitBoard snipers = BBTools::attack<P_wb>(k, p.pieces<P_wb>(~side) | p.pieces<P_wq>(~side), empty)
+                     | BBTools::attack<P_wr>(k, p.pieces<P_wr>(~side) | p.pieces<P_wq>(~side), empty);
+    while (snipers){
+        const Square s = popBit(snipers);
+        const BitBoard b = BBTools::mask[s].between[k] & p.occupancy;
+        if ( countBit(b) == 1 && (b & p.allPieces[side]) ){
+            li.pinned |= b;
+            li.pinRay[BitScanForward(b)] = BBTools::mask[s].between[k] | SquareToBitboard(s);
+        }
+    }
+}
+
+bool isLegal(const Position & p, const Move m, const LegalInfo & li){
+    const Color side = p.c;
+    const Square k = p.king(side);
+    const Square from = Move2From(m);
+    const Square to = Move2To(m);
+    const MType t = Move2Type(m);
+    if ( isCastling(t) ){ // path was checked by the generator, king destination is checked with the rook moved (FRC)
+        const bool qs = t == T_wqs || t == T_bqs;
+        const Square rookFrom = p.rooksInit[side][qs ? CT_OOO : CT_OO];
+        const Square rookTo = qs ? (side == Co_White ? Sq_d1 : Sq_d8) : (side == Co_White ? Sq_f1 : Sq_f8);
+        const BitBoard occ = (p.occupancy & ~SquareToBitboard(k) & ~SquareToBitboard(rookFrom)) | SquareToBitboard(to) | SquareToBitboard(rookTo);
+        return BBTools::allAttackedBB(p, to, side, occ) == empty;
+    }
+    if ( from == k ) return BBTools::allAttackedBB(p, to, side, p.occupancy ^ SquareToBitboard(k)) == empty; // king cannot hide on the checking ray
+    if ( t == T_ep ){ // both pawns leave their rank, the king is checked with the resulting occupancy
+        const Square epCapSq = to + (side == Co_White ? -8 : +8);
+        const BitBoard occ = (p.occupancy ^ SquareToBitboard(from) ^ SquareToBitboard(epCapSq)) | SquareToBitboard(to);
+        return (BBTools::allAttackedBB(p, k, side, occ) & ~SquareToBitboard(epCapSq)) == empty;
+    }
+    if ( li.pinned & SquareToBitboard(from) ) return (li.pinRay[from] & SquareToBitboard(to)) != empty;
+    return true;
+}
+
+template < Color C >
+void generateEvasions(const Position & p, const LegalInfo & li, MoveList & moves, GenPhase phase){
+    const Square k = p.king(C);
+    const BitBoard oppPieceBB = p.allPieces[~C];
+    // king steps, attacks are computed without the king so that it cannot step back on the checking ray
+    BitBoard bb = BBTools::mask[k].king & ~p.allPieces[C];
+    while (bb){
+        const Square to = popBit(bb);
+        const bool isCap = (oppPieceBB & SquareToBitboard(to)) != empty;
+        if ( inPhase(phase,isCap) && BBTools::allAttackedBB(p, to, C, p.occupancy ^ SquareToBitboard(k)) == empty ) addMove(k, to, isCap ? T_capture : T_std, moves);
+    }
+    if ( countBit(li.checkers) > 1 ) return; // double check, only the king can move
+    // a pinned piece can never capture or block the checker
+    const BitBoard block = BBTools::mask[BitScanForward(li.checkers)].between[k];
+    const BitBoard capTarget  = phase != GP_quiet ? li.checkers : empty;
+    const BitBoard pushTarget = phase != GP_cap   ? block       : empty;
+    const BitBoard unpinned = ~li.pinned;
+    generatePawnMoves<C>(p, moves, p.pieces<P_wp>(C) & unpinned, capTarget, pushTarget);
+    generatePieceMoves<C,P_wn>(p, moves, p.pieces<P_wn>(C) & unpinned, capTarget | pushTarget);
+    generatePieceMoves<C,P_wb>(p, moves, p.pieces<P_wb>(C) & unpinned, capTarget | pushTarget);
+    generatePieceMoves<C,P_wr>(p, moves, p.pieces<P_wr>(C) & unpinned, capTarget | pushTarget);
+    generatePieceMoves<C,P_wq>(p, moves, p.pieces<P_wq>(C) & unpinned, capTarget | pushTarget);
+    if ( phase != GP_quiet && p.ep != INVALIDSQUARE ){ // the pawn to be taken is the checker, or the ep square is blocking
+        const Square epCapSq = p.ep + (C == Co_White ? -8 : +8);
+        if ( (li.checkers & SquareToBitboard(epCapSq)) || (block & SquareToBitboard(p.ep)) ){
+            BitBoard pawns = BBTools::mask[p.ep].pawnAttack[~C] & p.pieces<P_wp>(C) & unpinned;
+            while (pawns){
+                const Move m = ToMove(popBit(pawns), p.ep, T_ep, 0);
+                if ( isLegal(p, m, li) ) moves.push_back(m);
+            }
+        }
+    }
+}
+
+void generateEvasions(const Position & p, const LegalInfo & li, MoveList & moves, GenPhase phase){
+    START_TIMER
+    assert(li.checkers != empty);
+    if ( p.c == Co_White ) generateEvasions<Co_White>(p,li,moves,phase);
+    else                   generateEvasions<Co_Black>(p,li,moves,phase);
+    STOP_AND_SUM_TIMER(Generate)
+}
+
 } // MoveGen
 
 void movePiece(Position & p, Square from, Square to, Piece fromP, Piece toP, bool isCapture, Piece prom) {
@@ -31,6 +119,8 @@ void movePiece(Position & p, Square from, Square to, Piece fromP, Piece toP, boo
     BBTools::unSetBit(p, from, fromP);
     BBTools::unSetBit(p, to,   toP); // usefull only if move is a capture
     BBTools::setBit  (p, to,   toPnew);
+    // update PST
+    p.psqt += PSQT(toPnew,to) - PSQT(fromP,from);
     // update Zobrist hash
     p.h ^= Zobrist::ZT[from][fromId]; // remove fromP at from
     p.h ^= Zobrist::ZT[to][toIdnew]; // add fromP (or prom) at to
@@ -39,6 +129,7 @@ void movePiece(Position & p, Square from, Square to, Piece fromP, Piece toP, boo
        if ( prom == P_none) p.ph ^= Zobrist::ZT[to][toIdnew]; // add fromP (if not prom) at to
     }
     if (isCapture) { // if capture remove toP at to
+        p.psqt -= PSQT(toP,to);
         p.h ^= Zobrist::ZT[to][toId];
         if ( (abs(toP) == P_wp || abs(toP) == P_wk) ) p.ph ^= Zobrist::ZT[to][toId];
     }
@@ -53,16 +144,92 @@ void applyNull(Searcher & context, Position & pN) {
     if (pN.ep != INVALIDSQUARE) pN.h ^= Zobrist::ZT[pN.ep][13];
     pN.ep = INVALIDSQUARE;
     pN.lastMove = NULLMOVE;
-    if ( pN.c == Co_White ) ++pN.moves;
     ++pN.halfmoves;
     STOP_AND_SUM_TIMER(Apply)
 }
 
+Hash keyAfter(const Position & p, const Move & m){
+    const Square from  = Move2From(m);
+    const Square to    = Move2To(m);
+    const MType  type  = Move2Type(m);
+    const Piece  fromP = p.b[from];
+    const Piece  toP   = p.b[to];
+    Hash h = computeHash(p) ^ Zobrist::ZT[3][13] ^ Zobrist::ZT[4][13];
+    if (p.ep != INVALIDSQUARE) h ^= Zobrist::ZT[p.ep][13];
+    CastlingRights castling = p.castling;
+    if ( isCastling(m) ){
+        const CastlingTypes ct = (type == T_wks || type == T_bks) ? CT_OO : CT_OOO;
+        const Piece pk = p.c == Co_White ? P_wk : P_bk;
+        const Piece pr = p.c == Co_White ? P_wr : P_br;
+        const Square kingDest = ct == CT_OO ? (p.c == Co_White ? Sq_g1 : Sq_g8) : (p.c == Co_White ? Sq_c1 : Sq_c8);
+        const Square rookDest = ct == CT_OO ? (p.c == Co_White ? Sq_f1 : Sq_f8) : (p.c == Co_White ? Sq_d1 : Sq_d8);
+        h ^= Zobrist::ZT[p.king(p.c)][pk+PieceShift] ^ Zobrist::ZT[kingDest][pk+PieceShift];
+        h ^= Zobrist::ZT[p.rooksInit[p.c][ct]][pr+PieceShift] ^ Zobrist::ZT[rookDest][pr+PieceShift];
+        castling &= p.c == Co_White ? ~(C_wks | C_wqs) : ~(C_bks | C_bqs);
+    }
+    else if ( type == T_ep ){
+        const Square epCapSq = p.ep + (p.c == Co_White ? -8 : +8);
+        h ^= Zobrist::ZT[from][fromP+PieceShift] ^ Zobrist::ZT[to][fromP+PieceShift] ^ Zobrist::ZT[epCapSq][-fromP+PieceShift];
+    }
+    else{
+        const Piece toPnew = isPromotion(type) ? Piece(promShift(type) * (p.c == Co_White ? 1 : -1)) : fromP;
+        h ^= Zobrist::ZT[from][fromP+PieceShift] ^ Zobrist::ZT[to][toPnew+PieceShift];
+        if ( toP != P_none ) h ^= Zobrist::ZT[to][toP+PieceShift];
+        if      ( fromP == P_wk ) castling &= ~(C_wks | C_wqs);
+        else if ( fromP == P_bk ) castling &= ~(C_bks | C_bqs);
+        if ( castling != C_none ){
+            if ( from == p.rooksInit[Co_White][CT_OOO] && fromP == P_wr ) castling &= ~C_wqs;
+            if ( from == p.rooksInit[Co_White][CT_OO]  && fromP == P_wr ) castling &= ~C_wks;
+            if ( from == p.rooksInit[Co_Black][CT_OOO] && fromP == P_br ) castling &= ~C_bqs;
+            if ( from == p.rooksInit[Co_Black][CT_OO]  && fromP == P_br ) castling &= ~C_bks;
+            if ( to == p.rooksInit[Co_White][CT_OOO] && toP == P_wr ) castling &= ~C_wqs;
+            if ( to == p.rooksInit[Co_White][CT_OO]  && toP == P_wr ) castling &= ~C_wks;
+            if ( to == p.rooksInit[Co_Black][CT_OOO] && toP == P_br ) castling &= ~C_bqs;
+            if ( to == p.rooksInit[Co_Black][CT_OO]  && toP == P_br ) castling &= ~C_bks;
+        }
+        if ( std::abs(fromP) == P_wp && std::abs(to-from) == 16 ) h ^= Zobrist::ZT[(from+to)/2][13];
+    }
+    const CastlingRights lost = p.castling & ~castling;
+    if ( lost & C_wks ) h ^= Zobrist::ZT[7][13];
+    if ( lost & C_wqs ) h ^= Zobrist::ZT[0][13];
+    if ( lost & C_bks ) h ^= Zobrist::ZT[63][13];
+    if ( lost & C_bqs ) h ^= Zobrist::ZT[56][13];
+    return h;
+}
+
+Hash pawnKeyAfter(const Position & p, const Move & m){
+    const Square from  = Move2From(m);
+    const Square to    = Move2To(m);
+    const MType  type  = Move2Type(m);
+    const Piece  fromP = p.b[from];
+    const Piece  toP   = p.b[to];
+    Hash h = computePHash(p);
+    if ( isCastling(m) ){
+        const Piece pk = p.c == Co_White ? P_wk : P_bk;
+        const Square kingDest = (type == T_wks || type == T_bks) ? (p.c == Co_White ? Sq_g1 : Sq_g8) : (p.c == Co_White ? Sq_c1 : Sq_c8);
+        return h ^ Zobrist::ZT[p.king(p.c)][pk+PieceShift] ^ Zobrist::ZT[kingDest][pk+PieceShift];
+    }
+    if ( type == T_ep ){
+        const Square epCapSq = p.ep + (p.c == Co_White ? -8 : +8);
+        return h ^ Zobrist::ZT[from][fromP+PieceShift] ^ Zobrist::ZT[to][fromP+PieceShift] ^ Zobrist::ZT[epCapSq][-fromP+PieceShift];
+    }
+    if ( std::abs(fromP) == P_wp || std::abs(fromP) == P_wk ){
+        h ^= Zobrist::ZT[from][fromP+PieceShift];
+        if ( !isPromotion(type) ) h ^= Zobrist::ZT[to][fromP+PieceShift];
+    }
+    if ( std::abs(toP) == P_wp || std::abs(toP) == P_wk ) h ^= Zobrist::ZT[to][toP+PieceShift];
+    return h;
+}
+
 bool apply(Position & p, const Move & m, bool noValidation){
     START_TIMER
     assert(VALIDMOVE(m));
 #ifdef DEBUG_MATERIAL
     Position previous = p;
+#endif
+#ifdef DEBUG_HASH
+    const Hash hAfter  = keyAfter(p,m);
+    const Hash phAfter = pawnKeyAfter(p,m);
 #endif
     const Square from  = Move2From(m);
     const Square to    = Move2To(m);
@@ -85,21 +252,15 @@ bool apply(Position & p, const Move & m, bool noValidation){
 
         // update castling rigths and king position
         if ( fromP == P_wk ){
-            p.king[Co_White] = to;
             if (p.castling & C_wks) p.h ^= Zobrist::ZT[7][13];
             if (p.castling & C_wqs) p.h ^= Zobrist::ZT[0][13];
             p.castling &= ~(C_wks | C_wqs);
         }
         else if ( fromP == P_bk ){
-            p.king[Co_Black] = to;
             if (p.castling & C_bks) p.h ^= Zobrist::ZT[63][13];
             if (p.castling & C_bqs) p.h ^= Zobrist::ZT[56][13];
             p.castling &= ~(C_bks | C_bqs);
         }
-        // king capture : is that necessary ???
-        if      ( toP == P_wk ) p.king[Co_White] = INVALIDSQUARE;
-        else if ( toP == P_bk ) p.king[Co_Black] = INVALIDSQUARE;
-
         if ( p.castling != C_none ){
            if ( (p.castling & C_wqs) && from == p.rooksInit[Co_White][CT_OOO] && fromP == P_wr ){
                p.castling &= ~C_wqs;
@@ -132,6 +293,8 @@ bool apply(Position & p, const Move & m, bool noValidation){
         p.b[to] = fromP;
         p.b[epCapSq] = P_none;
 
+        p.psqt += PSQT(fromP,to) - PSQT(fromP,from) - PSQT(Piece(-fromP),epCapSq);
+
         p.h ^= Zobrist::ZT[from][fromId]; // remove fromP at from
         p.h ^= Zobrist::ZT[epCapSq][(p.c == Co_White ? P_bp : P_wp) + PieceShift]; // remove captured pawn
         p.h ^= Zobrist::ZT[to][fromId]; // add fromP at to
@@ -221,7 +384,6 @@ bool apply(Position & p, const Move & m, bool noValidation){
     // update game state
     if ( toP != P_none || abs(fromP) == P_wp ) p.fifty = 0;
     else ++p.fifty;
-    if ( p.c == Co_White ) ++p.moves;
     ++p.halfmoves;
 
     MaterialHash::updateMaterialOther(p);
@@ -231,25 +393,110 @@ bool apply(Position & p, const Move & m, bool noValidation){
     if ( p.mat != mat ){ Logging::LogIt(Logging::logFatal) << "Material update error" << ToString(previous) << ToString(previous.mat) << ToString(p) << ToString(p.lastMove) << ToString(m) << ToString(mat) << ToString(p.mat); }
 #endif
     p.lastMove = m;
+#ifdef DEBUG_HASH
+    if ( p.h != hAfter || p.ph != phAfter ){ Logging::LogIt(Logging::logFatal) << "keyAfter error " << ToString(p) << ToString(m); }
+#endif
     STOP_AND_SUM_TIMER(Apply)
     return true;
 }
 
+#ifdef WITH_MAKE_UNMAKE
+bool apply(Position & p, const Move & m, UndoInfo & u, bool noValidation){
+    u.h = p.h;
+    u.ph = p.ph;
+    u.mat = p.mat;
+    u.psqt = p.psqt;
+    u.lastMove = p.lastMove;
+    u.halfmoves = p.halfmoves;
+    u.ep = p.ep;
+    u.fifty = p.fifty;
+    u.castling = p.castling;
+    u.c = p.c;
+    u.captured = Move2Type(m) == T_ep ? P_none : p.b[Move2To(m)];
+    return apply(p, m, noValidation);
+}
+
+void unapply(Position & p, const Move & m, const UndoInfo & u){
+    START_TIMER
+    const Square from = Move2From(m);
+    const Square to   = Move2To(m);
+    const MType  type = Move2Type(m);
+    const Color  c    = u.c;
+    switch(type){
+    case T_wks:
+    case T_wqs:
+    case T_bks:
+    case T_bqs: {
+        const CastlingTypes ct = (type == T_wks || type == T_bks) ? CT_OO : CT_OOO;
+        const Square rookFrom = p.rooksInit[c][ct];
+        const Square rookDest = ct == CT_OO ? (c == Co_White ? Sq_f1 : Sq_f8) : (c == Co_White ? Sq_d1 : Sq_d8);
+        const Piece pk = c == Co_White ? P_wk : P_bk;
+        const Piece pr = c == Co_White ? P_wr : P_br;
+        // both pieces are removed first, squares can overlap in FRC
+        BBTools::unSetBit(p, to, pk);
+        BBTools::unSetBit(p, rookDest, pr);
+        p.b[to] = P_none;
+        p.b[rookDest] = P_none;
+        BBTools::setBit(p, from, pk);
+        BBTools::setBit(p, rookFrom, pr);
+        p.b[from] = pk;
+        p.b[rookFrom] = pr;
+    }
+        break;
+    case T_ep: {
+        const Piece pawn = c == Co_White ? P_wp : P_bp;
+        const Square epCapSq = to + (c == Co_White ? -8 : +8);
+        BBTools::unSetBit(p, to, pawn);
+        BBTools::setBit(p, from, pawn);
+        BBTools::setBit(p, epCapSq, Piece(-pawn));
+        p.b[to] = P_none;
+        p.b[from] = pawn;
+        p.b[epCapSq] = Piece(-pawn);
+    }
+        break;
+    default: {
+        const Piece moved = isPromotion(type) ? (c == Co_White ? P_wp : P_bp) : p.b[to];
+        BBTools::unSetBit(p, to, p.b[to]);
+        BBTools::setBit(p, from, moved);
+        if ( u.captured != P_none ) BBTools::setBit(p, to, u.captured);
+        p.b[from] = moved;
+        p.b[to] = u.captured;
+    }
+    }
+
+    p.allPieces[Co_White] = p.whitePawn() | p.whiteKnight() | p.whiteBishop() | p.whiteRook() | p.whiteQueen() | p.whiteKing();
+    p.allPieces[Co_Black] = p.blackPawn() | p.blackKnight() | p.blackBishop() | p.blackRook() | p.blackQueen() | p.blackKing();
+    p.occupancy = p.allPieces[Co_White] | p.allPieces[Co_Black];
+
+    p.h = u.h;
+    p.ph = u.ph;
+    p.mat = u.mat;
+    p.psqt = u.psqt;
+    p.lastMove = u.lastMove;
+    p.halfmoves = u.halfmoves;
+    p.ep = u.ep;
+    p.fifty = u.fifty;
+    p.castling = u.castling;
+    p.c = c;
+    STOP_AND_SUM_TIMER(Apply)
+}
+#endif
+
 ScoreType randomMover(const Position & p, PVList & pv, bool isInCheck) {
     MoveList moves;
-    MoveGen::generate<MoveGen::GP_all>(p, moves, false);
+    MoveGen::generateLegal<MoveGen::GP_all>(p, moves, false);
     if (moves.empty()) return isInCheck ? -MATE : 0;
     static std::random_device rd;
     static std::mt19937 g(rd());
     std::shuffle(moves.begin(), moves.end(),g);
     for (auto it = moves.begin(); it != moves.end(); ++it) {
         Position p2 = p;
-        if (!apply(p2, *it)) continue;
+        apply(p2, *it, true);
         PVList childPV;
         updatePV(pv, *it, childPV);
         const Square to = Move2To(*it);
-        if (p.c == Co_White && to == p.king[Co_Black]) return MATE + 1;
-        if (p.c == Co_Black && to == p.king[Co_White]) return MATE + 1;
+        if (p.c == Co_White && to == p.king(Co_Black)) return MATE + 1;
+        if (p.c == Co_Black && to == p.king(Co_White)) return MATE + 1;
         return 0;
     }
     return isInCheck ? -MATE : 0;
@@ -305,21 +552,21 @@ bool isPseudoLegal2(const Position & p, Move m) { // validate TT move
     if (isPromotion(m) && fromPieceType != P_wp) PSEUDO_LEGAL_RETURN(false)
     if (isCastling(m)) {
         if (p.c == Co_White) {
-            if (t == T_wqs && (p.castling & C_wqs) && from == p.kingInit[Co_White] && fromP == P_wk && to == Sq_c1 && toP == P_none
-                && (((BBTools::mask[p.king[Co_White]].between[Sq_c1] | BBTools::mask[p.rooksInit[Co_White][CT_OOO]].between[Sq_d1]) & p.occupancy) == empty)
-                && !isAttacked(p, BBTools::mask[p.king[Co_White]].between[Sq_c1] | SquareToBitboard(p.king[Co_White]))) PSEUDO_LEGAL_RETURN(true)
-            if (t == T_wks && (p.castling & C_wks) && from == p.kingInit[Co_White] && fromP == P_wk && to == Sq_g1 && toP == P_none
-                && (((BBTools::mask[p.king[Co_White]].between[Sq_g1] | BBTools::mask[p.rooksInit[Co_White][CT_OO]].between[Sq_f1]) & p.occupancy) == empty)
-                && !isAttacked(p, BBTools::mask[p.king[Co_White]].between[Sq_g1] | SquareToBitboard(p.king[Co_White]))) PSEUDO_LEGAL_RETURN(true)
+            if (t == T_wqs && (p.castling & C_wqs) && from == p.king(Co_White) && fromP == P_wk && to == Sq_c1 && toP == P_none
+                && (((BBTools::mask[p.king(Co_White)].between[Sq_c1] | BBTools::mask[p.rooksInit[Co_White][CT_OOO]].between[Sq_d1]) & p.occupancy) == empty)
+                && !isAttacked(p, BBTools::mask[p.king(Co_White)].between[Sq_c1] | SquareToBitboard(p.king(Co_White)))) PSEUDO_LEGAL_RETURN(true)
+            if (t == T_wks && (p.castling & C_wks) && from == p.king(Co_White) && fromP == P_wk && to == Sq_g1 && toP == P_none
+                && (((BBTools::mask[p.king(Co_White)].between[Sq_g1] | BBTools::mask[p.rooksInit[Co_White][CT_OO]].between[Sq_f1]) & p.occupancy) == empty)
+                && !isAttacked(p, BBTools::mask[p.king(Co_White)].between[Sq_g1] | SquareToBitboard(p.king(Co_White)))) PSEUDO_LEGAL_RETURN(true)
             PSEUDO_LEGAL_RETURN(false)
         }
         else {
-            if (t == T_bqs && (p.castling & C_bqs) && from == p.kingInit[Co_Black] && fromP == P_bk && to == Sq_c8 && toP == P_none
-                && (((BBTools::mask[p.king[Co_Black]].between[Sq_c8] | BBTools::mask[p.rooksInit[Co_Black][CT_OOO]].between[Sq_d8]) & p.occupancy) == empty)
-                && !isAttacked(p, BBTools::mask[p.king[Co_Black]].between[Sq_c8] | SquareToBitboard(p.king[Co_Black]))) PSEUDO_LEGAL_RETURN(true)
-            if (t == T_bks && (p.castling & C_bks) && from == p.kingInit[Co_Black] && fromP == P_bk && to == Sq_g8 && toP == P_none
-                && (((BBTools::mask[p.king[Co_Black]].between[Sq_g8] | BBTools::mask[p.rooksInit[Co_Black][CT_OO]].between[Sq_f8]) & p.occupancy) == empty)
-                && !isAttacked(p, BBTools::mask[p.king[Co_Black]].between[Sq_g8] | SquareToBitboard(p.king[Co_Black]))) PSEUDO_LEGAL_RETURN(true)
+            if (t == T_bqs && (p.castling & C_bqs) && from == p.king(Co_Black) && fromP == P_bk && to == Sq_c8 && toP == P_none
+                && (((BBTools::mask[p.king(Co_Black)].between[Sq_c8] | BBTools::mask[p.rooksInit[Co_Black][CT_OOO]].between[Sq_d8]) & p.occupancy) == empty)
+                && !isAttacked(p, BBTools::mask[p.king(Co_Black)].between[Sq_c8] | SquareToBitboard(p.king(Co_Black)))) PSEUDO_LEGAL_RETURN(true)
+            if (t == T_bks && (p.castling & C_bks) && from == p.king(Co_Black) && fromP == P_bk && to == Sq_g8 && toP == P_none
+                && (((BBTools::mask[p.king(Co_Black)].between[Sq_g8] | BBTools::mask[p.rooksInit[Co_Black][CT_OO]].between[Sq_f8]) & p.occupancy) == empty)
+                && !isAttacked(p, BBTools::mask[p.king(Co_Black)].between[Sq_g8] | SquareToBitboard(p.king(Co_Black)))) PSEUDO_LEGAL_RETURN(true)
             PSEUDO_LEGAL_RETURN(false)
         }
     }
@@ -339,7 +586,7 @@ bool isPseudoLegal2(const Position & p, Move m) { // validate TT move
         if ((BBTools::pfCoverage[fromPieceType - 1](from, p.occupancy, p.c) & SquareToBitboard(to)) != empty) PSEUDO_LEGAL_RETURN(true)
         PSEUDO_LEGAL_RETURN(false)
     }
-    if ((BBTools::mask[p.king[p.c]].kingZone & SquareToBitboard(to)) != empty) PSEUDO_LEGAL_RETURN(true) // only king is not verified yet
+    if ((BBTools::mask[p.king(p.c)].kingZone & SquareToBitboard(to)) != empty) PSEUDO_LEGAL_RETURN(true) // only king is not verified yet
     PSEUDO_LEGAL_RETURN(false)
 }
 
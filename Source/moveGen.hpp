@@ -5,6 +5,7 @@
 #include "attack.hpp"
 #include "bitboardTools.hpp"
 #include "hash.hpp"
+#include "positionTools.hpp"
 #include "timers.hpp"
 
 struct Searcher;
@@ -15,6 +16,108 @@ enum GenPhase { GP_all = 0, GP_cap = 1, GP_quiet = 2 };
 
 void addMove(Square from, Square to, MType type, MoveList & moves);
 
+// legality information computed once per node : checkers of the side to move king and its pinned pieces,
+// each pinned piece can only move on its pin ray (between king and pinner, pinner included)
+struct LegalInfo{
+    BitBoard checkers, pinned;
+    BitBoard pinRay[64]; // only valid for pinned pieces
+};
+
+void initLegalInfo(const Position & p, LegalInfo & li);
+
+// is this generated (pseudo-legal) move legal, without applying it. Only used when not in check.
+bool isLegal(const Position & p, const Move m, const LegalInfo & li);
+
+// dedicated check evasion generator : king steps, and if single check, captures of the checker or blocks by unpinned pieces
+void generateEvasions(const Position & p, const LegalInfo & li, MoveList & moves, GenPhase phase);
+
+template < int delta, bool isCap >
+inline void addPawnMoves(BitBoard targets, const BitBoard promRank, MoveList & moves){
+    BitBoard proms = targets & promRank;
+    targets &= ~promRank;
+    while (targets) {
+        const Square to = popBit(targets);
+        addMove(to - delta, to, isCap ? T_capture : T_std, moves);
+    }
+    while (proms) {
+        const Square to = popBit(proms);
+        addMove(to - delta, to, isCap ? T_cappromq : T_promq, moves);
+        addMove(to - delta, to, isCap ? T_cappromr : T_promr, moves);
+        addMove(to - delta, to, isCap ? T_cappromb : T_promb, moves);
+        addMove(to - delta, to, isCap ? T_cappromn : T_promn, moves);
+    }
+}
+
+// set-wise pawn moves, targets of the whole pawn bitboard are given by shifts and origin is found back from the shift
+template < Color C >
+inline void generatePawnMoves(const Position & p, MoveList & moves, const BitBoard pawns, const BitBoard capTarget, const BitBoard pushTarget){
+    const BitBoard promRank  = C == Co_White ? rank8 : rank1;
+    const BitBoard thirdRank = C == Co_White ? rank3 : rank6;
+    if ( capTarget ){
+        addPawnMoves<C == Co_White ? 7 : -9, true>(BBTools::shiftNW<C>(pawns) & capTarget, promRank, moves);
+        addPawnMoves<C == Co_White ? 9 : -7, true>(BBTools::shiftNE<C>(pawns) & capTarget, promRank, moves);
+    }
+    if ( pushTarget ){
+        const BitBoard single = BBTools::shiftN<C>(pawns) & ~p.occupancy;
+        addPawnMoves<C == Co_White ? 8 : -8, false>(single & pushTarget, promRank, moves);
+        BitBoard dpush = BBTools::shiftN<C>(single & thirdRank) & ~p.occupancy & pushTarget;
+        while (dpush) {
+            const Square to = popBit(dpush);
+            addMove(to + (C == Co_White ? -16 : 16), to, T_std, moves);
+        }
+    }
+}
+
+template < Color C >
+inline void generateEp(const Position & p, MoveList & moves, const BitBoard pawns){
+    if ( p.ep == INVALIDSQUARE ) return;
+    BitBoard bb = BBTools::mask[p.ep].pawnAttack[~C] & pawns;
+    while (bb) addMove(popBit(bb), p.ep, T_ep, moves);
+}
+
+// direct (inlined) attack call, no function pointer dispatch
+template < Color C, Piece T >
+inline void generatePieceMoves(const Position & p, MoveList & moves, BitBoard pieces, const BitBoard target){
+    const BitBoard oppPieceBB = p.allPieces[~C];
+    while (pieces) {
+        const Square from = popBit(pieces);
+        BitBoard bb = BBTools::coverage<T>(from, p.occupancy, C) & target;
+        while (bb) {
+            const Square to = popBit(bb);
+            addMove(from, to, (oppPieceBB & SquareToBitboard(to)) ? T_capture : T_std, moves);
+        }
+    }
+}
+
+template < Color C >
+inline void generateCastling(const Position & p, MoveList & moves){
+    const Square k = p.king(C);
+    const Square kingOOO = C == Co_White ? Sq_c1 : Sq_c8;
+    const Square rookOOO = C == Co_White ? Sq_d1 : Sq_d8;
+    const Square kingOO  = C == Co_White ? Sq_g1 : Sq_g8;
+    const Square rookOO  = C == Co_White ? Sq_f1 : Sq_f8;
+    if ( (p.castling & (C == Co_White ? C_wqs : C_bqs))
+         && ( ( (BBTools::mask[k].between[kingOOO] | BBTools::mask[p.rooksInit[C][CT_OOO]].between[rookOOO]) & p.occupancy) == empty)
+         && !isAttacked(p,BBTools::mask[k].between[kingOOO] | SquareToBitboard(k)) ) addMove(k, kingOOO, C == Co_White ? T_wqs : T_bqs, moves);
+    if ( (p.castling & (C == Co_White ? C_wks : C_bks))
+         && ( ( (BBTools::mask[k].between[kingOO] | BBTools::mask[p.rooksInit[C][CT_OO]].between[rookOO]) & p.occupancy) == empty)
+         && !isAttacked(p,BBTools::mask[k].between[kingOO] | SquareToBitboard(k)) ) addMove(k, kingOO, C == Co_White ? T_wks : T_bks, moves);
+}
+
+template < Color C, GenPhase phase >
+inline void generateColor(const Position & p, MoveList & moves){
+    const BitBoard target = phase == GP_cap ? p.allPieces[~C] : phase == GP_quiet ? ~p.occupancy : ~p.allPieces[C];
+    generatePawnMoves<C>(p, moves, p.pieces<P_wp>(C), phase != GP_quiet ? p.allPieces[~C] : empty, phase != GP_cap ? ~empty : empty);
+    if ( phase != GP_quiet ) generateEp<C>(p, moves, p.pieces<P_wp>(C));
+    generatePieceMoves<C,P_wn>(p, moves, p.pieces<P_wn>(C), target);
+    generatePieceMoves<C,P_wb>(p, moves, p.pieces<P_wb>(C), target);
+    generatePieceMoves<C,P_wr>(p, moves, p.pieces<P_wr>(C), target);
+    generatePieceMoves<C,P_wq>(p, moves, p.pieces<P_wq>(C), target);
+    generatePieceMoves<C,P_wk>(p, moves, p.pieces<P_wk>(C), target);
+    if ( phase != GP_cap && (p.castling & (C == Co_White ? (C_wqs|C_wks) : (C_bqs|C_bks))) ) generateCastling<C>(p, moves);
+}
+
+// moves of a single piece (used outside search, for move parsing for instance)
 template < GenPhase phase = GP_all >
 void generateSquare(const Position & p, MoveList & moves, Square from){
     assert(from != INVALIDSQUARE);
@@ -35,52 +138,14 @@ void generateSquare(const Position & p, MoveList & moves, Square from){
             else addMove(from,to,T_std,moves);
         }
         if ( phase != GP_cap && ptype == P_wk ){ // castling
-            if ( side == Co_White) {
-                if ( p.castling & (C_wqs|C_wks) ){
-                   if ( (p.castling & C_wqs)
-                        && ( ( (BBTools::mask[p.king[Co_White]].between[Sq_c1] | BBTools::mask[p.rooksInit[Co_White][CT_OOO]].between[Sq_d1]) & p.occupancy) == empty)
-                        && !isAttacked(p,BBTools::mask[p.king[Co_White]].between[Sq_c1] | SquareToBitboard(p.king[Co_White])) ) addMove(from, Sq_c1, T_wqs, moves); // wqs
-                   if ( (p.castling & C_wks)
-                        && ( ( (BBTools::mask[p.king[Co_White]].between[Sq_g1] | BBTools::mask[p.rooksInit[Co_White][CT_OO ]].between[Sq_f1]) & p.occupancy) == empty)
-                        && !isAttacked(p,BBTools::mask[p.king[Co_White]].between[Sq_g1] | SquareToBitboard(p.king[Co_White])) ) addMove(from, Sq_g1, T_wks, moves); // wks
-                }
-            }
-            else if ( p.castling & (C_bqs|C_bks)){
-                if ( (p.castling & C_bqs)
-                     && ( ( (BBTools::mask[p.king[Co_Black]].between[Sq_c8] | BBTools::mask[p.rooksInit[Co_Black][CT_OOO]].between[Sq_d8]) & p.occupancy) == empty)
-                     && !isAttacked(p,BBTools::mask[p.king[Co_Black]].between[Sq_c8] | SquareToBitboard(p.king[Co_Black])) ) addMove(from, Sq_c8, T_bqs, moves); // bqs
-                if ( (p.castling & C_bks)
-                     && ( ( (BBTools::mask[p.king[Co_Black]].between[Sq_g8] | BBTools::mask[p.rooksInit[Co_Black][CT_OO ]].between[Sq_f8]) & p.occupancy) == empty)
-                     && !isAttacked(p,BBTools::mask[p.king[Co_Black]].between[Sq_g8] | SquareToBitboard(p.king[Co_Black])) ) addMove(from, Sq_g8, T_bks, moves); // bks
-            }
+            if ( side == Co_White ) generateCastling<Co_White>(p,moves);
+            else                    generateCastling<Co_Black>(p,moves);
         }
     }
     else {
-        BitBoard pawnmoves = empty;
-        static const BitBoard rank1_or_rank8 = rank1 | rank8;
-        if ( phase != GP_quiet) pawnmoves = BBTools::mask[from].pawnAttack[p.c] & ~myPieceBB & oppPieceBB;
-        while (pawnmoves) {
-            const Square to = popBit(pawnmoves);
-            if ( SquareToBitboard(to) & rank1_or_rank8 ) {
-                addMove(from, to, T_cappromq, moves); // pawn capture with promotion
-                addMove(from, to, T_cappromr, moves); // pawn capture with promotion
-                addMove(from, to, T_cappromb, moves); // pawn capture with promotion
-                addMove(from, to, T_cappromn, moves); // pawn capture with promotion
-            } else addMove(from,to,T_capture,moves);
-        }
-        if ( phase != GP_cap) pawnmoves |= BBTools::mask[from].push[p.c] & ~p.occupancy;
-        if ((phase != GP_cap) && (BBTools::mask[from].push[p.c] & p.occupancy) == empty) pawnmoves |= BBTools::mask[from].dpush[p.c] & ~p.occupancy;
-        while (pawnmoves) {
-            const Square to = popBit(pawnmoves);
-            if ( SquareToBitboard(to) & rank1_or_rank8 ) {
-                addMove(from, to, T_promq, moves); // promotion Q
-                addMove(from, to, T_promr, moves); // promotion R
-                addMove(from, to, T_promb, moves); // promotion B
-                addMove(from, to, T_promn, moves); // promotion N
-            } else addMove(from,to,T_std,moves);
-        }
-        if ( p.ep != INVALIDSQUARE && phase != GP_quiet ) pawnmoves = BBTools::mask[from].pawnAttack[p.c] & ~myPieceBB & SquareToBitboard(p.ep);
-        while (pawnmoves) addMove(from,popBit(pawnmoves),T_ep,moves);
+        const BitBoard pawn = SquareToBitboard(from);
+        if ( side == Co_White ) { generatePawnMoves<Co_White>(p, moves, pawn, phase != GP_quiet ? oppPieceBB : empty, phase != GP_cap ? ~empty : empty); if ( phase != GP_quiet ) generateEp<Co_White>(p, moves, pawn); }
+        else                    { generatePawnMoves<Co_Black>(p, moves, pawn, phase != GP_quiet ? oppPieceBB : empty, phase != GP_cap ? ~empty : empty); if ( phase != GP_quiet ) generateEp<Co_Black>(p, moves, pawn); }
     }
 }
 
@@ -88,11 +153,26 @@ template < GenPhase phase = GP_all >
 void generate(const Position & p, MoveList & moves, bool doNotClear = false){
     START_TIMER
     if (!doNotClear) moves.clear();
-    BitBoard myPieceBBiterator = ( (p.c == Co_White) ? p.allPieces[Co_White] : p.allPieces[Co_Black]);
-    while (myPieceBBiterator) generateSquare<phase>(p,moves,popBit(myPieceBBiterator));
+    if ( p.c == Co_White ) generateColor<Co_White,phase>(p,moves);
+    else                   generateColor<Co_Black,phase>(p,moves);
     STOP_AND_SUM_TIMER(Generate)
 }
 
+// only legal moves, so that no illegal move is ever copied or applied
+template < GenPhase phase = GP_all >
+void generateLegal(const Position & p, MoveList & moves, bool doNotClear = false){
+    if (!doNotClear) moves.clear();
+    if ( p.king(p.c) == INVALIDSQUARE ){ generate<phase>(p,moves,true); return; } // only in some test positions
+    LegalInfo li;
+    initLegalInfo(p,li);
+    if ( li.checkers ){ generateEvasions(p,li,moves,phase); return; }
+    const size_t first = moves.size();
+    generate<phase>(p,moves,true);
+    size_t n = first;
+    for (size_t k = first ; k < moves.size() ; ++k) if ( isLegal(p,moves[k],li) ) moves[n++] = moves[k];
+    moves.resize(n);
+}
+
 } // MoveGen
 
 void movePiece(Position & p, Square from, Square to, Piece fromP, Piece toP, bool isCapture = false, Piece prom = P_none);
@@ -104,23 +184,24 @@ inline void movePieceCastle(Position & p, CastlingTypes ct, Square kingDest, Squ
     const Piece pr = c==Co_White?P_wr:P_br;
     const CastlingRights ks = c==Co_White?C_wks:C_bks;
     const CastlingRights qs = c==Co_White?C_wqs:C_bqs;
+    const Square kingFrom = p.king(c); // derived from the king bitboard, so taken before it is changed
     const Square sks = c==Co_White?7:63;
     const Square sqs = c==Co_White?0:56;
-    BBTools::unSetBit(p, p.king[c]);
+    BBTools::unSetBit(p, kingFrom);
     BBTools::unSetBit(p, p.rooksInit[c][ct]);
     BBTools::setBit(p, kingDest, pk);
     BBTools::setBit(p, rookDest, pr);
-    p.b[p.king[c]] = P_none;
+    p.b[kingFrom] = P_none;
     p.b[p.rooksInit[c][ct]] = P_none;
     p.b[kingDest] = pk;
     p.b[rookDest] = pr;
-    p.h ^= Zobrist::ZT[p.king[c]][pk+PieceShift];
-    p.ph ^= Zobrist::ZT[p.king[c]][pk+PieceShift];
+    p.psqt += PSQT(pk,kingDest) - PSQT(pk,kingFrom) + PSQT(pr,rookDest) - PSQT(pr,p.rooksInit[c][ct]);
+    p.h ^= Zobrist::ZT[kingFrom][pk+PieceShift];
+    p.ph ^= Zobrist::ZT[kingFrom][pk+PieceShift];
     p.h ^= Zobrist::ZT[p.rooksInit[c][ct]][pr+PieceShift];
     p.h ^= Zobrist::ZT[kingDest][pk+PieceShift];
     p.ph ^= Zobrist::ZT[kingDest][pk+PieceShift];
     p.h ^= Zobrist::ZT[rookDest][pr+PieceShift];
-    p.king[c] = kingDest;
     if (p.castling & qs) p.h ^= Zobrist::ZT[sqs][13];
     if (p.castling & ks) p.h ^= Zobrist::ZT[sks][13];
     p.castling &= ~(ks | qs);
@@ -131,6 +212,40 @@ void applyNull(Searcher & context, Position & pN);
 
 bool apply(Position & p, const Move & m, bool noValidation = false);
 
+// Zobrist keys of the position after m, computed without applying the move (used to prefetch child entries)
+Hash keyAfter    (const Position & p, const Move & m);
+Hash pawnKeyAfter(const Position & p, const Move & m);
+
+#ifdef WITH_MAKE_UNMAKE
+// compact undo record, everything apply is changing that cannot be found back from the move itself
+struct UndoInfo{
+    Hash h, ph;
+    Position::Material mat;
+    EvalScore psqt;
+    Move lastMove;
+    unsigned short int halfmoves;
+    Square ep;
+    unsigned char fifty;
+    CastlingRights castling;
+    Color c;
+    Piece captured;
+};
+
+// same as apply but filling the undo record, unapply shall then be called even if the move was not valid
+bool apply(Position & p, const Move & m, UndoInfo & u, bool noValidation = false);
+void unapply(Position & p, const Move & m, const UndoInfo & u);
+
+// the move is applied on the given position and undone when leaving the scope
+struct ScopedMove{
+    ScopedMove(const Position & p, const Move m, bool noValidation = false):p(const_cast<Position&>(p)),m(m){ valid = apply(this->p,m,u,noValidation); }
+    ~ScopedMove(){ unapply(p,m,u); }
+    Position & p; // the searched position is given as const all along the search, but it is always restored here
+    const Move m;
+    UndoInfo u;
+    bool valid;
+};
+#endif
+
 ScoreType randomMover(const Position & p, PVList & pv, bool isInCheck);
 
 bool isPseudoLegal(const Position & p, Move m);
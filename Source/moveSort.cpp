@@ -1,6 +1,7 @@
 #include "moveSort.hpp"
 
 #include "logging.hpp"
+#include "moveGen.hpp"
 #include "searcher.hpp"
 
 /* Moves are sorted this way
@@ -65,3 +66,180 @@ void MoveSorter::computeScore(Move & m)const{
 }
 
 
+
+namespace{
+const unsigned int lazyPicks = 4; // after that many picks, the remaining moves of the stage are simply sorted
+inline Move stripScore(const Move m){ return m & 0x0000FFFF; }
+inline Move withScore(const Move m, ScoreType s){ return ToMove(Move2From(m), Move2To(m), Move2Type(m), s); }
+}
+
+MovePicker::MovePicker(const Searcher & context, const Position & p, float gp, DepthType ply, const CMHPtrArray & cmhPtr, PickerMode mode, bool isInCheck, const TT::Entry * e, const Move refutation, const MoveList * moveList)
+    :context(context),p(p),sorter(context,p,gp,ply,cmhPtr,mode != PM_qsearch,isInCheck,e,refutation),mode(mode){
+    if ( moveList ) moves = *moveList;
+    stage = mode == PM_all ? ST_genAll : ST_tt;
+    if ( e && e->h != nullHash && VALIDMOVE(e->m) ) ttMove = stripScore(e->m);
+    if ( mode == PM_main ){
+        // same scores as in MoveSorter
+        const KillerT & k = context.killerT;
+        if ( VALIDMOVE(k.killers[ply][0]) )              killers[nbKillers++] = withScore(k.killers[ply][0],1800);
+        if ( VALIDMOVE(k.killers[ply][1]) )              killers[nbKillers++] = withScore(k.killers[ply][1],1750);
+        if ( ply > 1 && VALIDMOVE(k.killers[ply-2][0]) ) killers[nbKillers++] = withScore(k.killers[ply-2][0],1700);
+        if ( VALIDMOVE(p.lastMove) )                     killers[nbKillers++] = withScore(stripScore(context.counterT.counter[Move2From(p.lastMove)][Move2To(p.lastMove)]),1650);
+    }
+}
+
+void MovePicker::initRange(size_t begin, size_t end_){
+    cur = begin;
+    end = end_;
+    picked = 0;
+    sorted = false;
+}
+
+void MovePicker::scoreRange(bool mvvLva){
+    START_TIMER
+    for (size_t k = cur ; k < end ; ++k){
+        Move & m = moves[k];
+        if ( mvvLva ){ // cheap score for captures, SEE will be computed later if needed
+            const MType t = Move2Type(m);
+            ScoreType s = MoveScoring[t];
+            if ( !isPromotion(t) ){
+                const Piece victim   = (t != T_ep) ? PieceTools::getPieceType(p,Move2To(m)) : P_wp;
+                const Piece attacker = PieceTools::getPieceType(p,Move2From(m));
+                s += SearchConfig::MvvLvaScores[victim-1][attacker-1];
+            }
+            m = ToMove(Move2From(m), Move2To(m), t, s);
+        }
+        else sorter.computeScore(m);
+    }
+    STOP_AND_SUM_TIMER(MoveSorting)
+}
+
+Move MovePicker::pickBest(){
+    assert(cur < end);
+    if ( !sorted && ++picked > lazyPicks ){
+        std::sort(moves.begin()+cur, moves.begin()+end, sorter);
+        sorted = true;
+    }
+    if ( !sorted ){
+        size_t best = cur;
+        for (size_t k = cur+1 ; k < end ; ++k) if ( Move2Score(moves[k]) > Move2Score(moves[best]) ) best = k;
+        std::swap(moves[cur],moves[best]);
+    }
+    return moves[cur];
+}
+
+bool MovePicker::alreadyGiven(const Move m)const{
+    if ( sameMove(m,ttMove) ) return true;
+    for (int k = 0 ; k < killerIdx ; ++k) if ( sameMove(m,killers[k]) ) return true;
+    return false;
+}
+
+Move MovePicker::peek()const{
+    switch(stage){
+    case ST_goodCaptures:
+    case ST_quiets:
+    case ST_badCaptures:
+    case ST_all:
+        return ( sorted && cur < end ) ? moves[cur] : INVALIDMOVE;
+    case ST_killers:
+        return ( killerIdx < nbKillers && Move2Type(killers[killerIdx]) == T_std ) ? killers[killerIdx] : INVALIDMOVE; // not validated yet
+    default:
+        return INVALIDMOVE;
+    }
+}
+
+Move MovePicker::next(){
+    while(true){
+        switch(stage){
+        case ST_tt:
+            stage = ST_genCaptures;
+            if ( mode == PM_qsearch && VALIDMOVE(ttMove) && isCapture(ttMove) && isLegal(ttMove) ) return withScore(ttMove, MoveScoring[Move2Type(ttMove)] + 15000);
+            break;
+        case ST_genCaptures:
+            if ( p.king(p.c) != INVALIDSQUARE ){ // checkers and pins only now, nodes cut by the TT move do not need them
+                MoveGen::initLegalInfo(p,legalInfo);
+                if ( !legalInfo.checkers ) li = &legalInfo; // isLegal is only valid outside of check
+            }
+            MoveGen::generate<MoveGen::GP_cap>(p,moves);
+            initRange(0,moves.size());
+            capEnd = end;
+            scoreRange(true);
+            stage = ST_goodCaptures;
+            break;
+        case ST_goodCaptures:
+            while ( cur < end ){
+                Move m = pickBest();
+                if ( sameMove(m,ttMove) || !isLegal(m) ){ ++cur; continue; } // already tried, or illegal
+                if ( mode != PM_qsearch && !isPromotion(m) ){ // SEE only now
+                    m = stripScore(m);
+                    sorter.computeScore(m);
+                    moves[cur] = m;
+                    if ( isBadCap(m) ){ // delayed, stored at the beginning of the list
+                        std::swap(moves[cur],moves[badEnd]);
+                        ++badEnd;
+                        ++cur;
+                        continue;
+                    }
+                }
+                ++cur;
+                return m;
+            }
+            stage = (mode == PM_main) ? ST_killers : ST_done;
+            break;
+        case ST_killers:
+            while ( killerIdx < nbKillers ){
+                const Move m = killers[killerIdx];
+                bool skip = Move2Type(m) != T_std || sameMove(m,ttMove);
+                for (int k = 0 ; k < killerIdx && !skip ; ++k) skip = sameMove(m,killers[k]);
+                if ( skip || !isPseudoLegal(p,m) || !isLegal(m) ){ // not given, shall not be skipped in quiet stage
+                    for (int k = killerIdx ; k < nbKillers-1 ; ++k) killers[k] = killers[k+1];
+                    --nbKillers;
+                    continue;
+                }
+                ++killerIdx;
+                return m;
+            }
+            stage = ST_genQuiets;
+            break;
+        case ST_genQuiets:
+            MoveGen::generate<MoveGen::GP_quiet>(p,moves,true);
+            initRange(capEnd,moves.size());
+            scoreRange(false);
+            stage = ST_quiets;
+            break;
+        case ST_quiets:
+            while ( cur < end ){
+                const Move m = pickBest();
+                ++cur;
+                if ( !alreadyGiven(m) && isLegal(m) ) return m;
+            }
+            initRange(0,badEnd);
+            stage = ST_badCaptures;
+            break;
+        case ST_badCaptures:
+            while ( cur < end ){
+                const Move m = pickBest();
+                ++cur;
+                return m; // already checked in good captures stage
+            }
+            stage = ST_done;
+            break;
+        case ST_genAll:
+            if ( moves.empty() ) MoveGen::generateLegal<MoveGen::GP_all>(p,moves); // given root moves are legal too
+            initRange(0,moves.size());
+            scoreRange(false);
+            stage = ST_all;
+            break;
+        case ST_all:
+            while ( cur < end ){
+                const Move m = pickBest();
+                ++cur;
+                return m;
+            }
+            stage = ST_done;
+            break;
+        case ST_done:
+            return INVALIDMOVE;
+        }
+    }
+}
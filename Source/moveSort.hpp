@@ -2,13 +2,14 @@
 
 #include "definition.hpp"
 
+#include "moveGen.hpp"
 #include "tables.hpp"
 #include "timers.hpp"
 #include "transposition.hpp"
 
-/* Minic is not sorting move on the fly, but once and for all
- * MoveSorter is storing needed information and computeScore function
- * will give each move a score. After that, sort is called on the MoveList
+/* MoveSorter is storing needed information and computeScore function
+ * will give each move a score. After that, sort can be called on the MoveList
+ * (this is what MovePicker is doing in some of its modes).
  * */
 
 struct MoveSorter{
@@ -41,3 +42,51 @@ struct MoveSorter{
         STOP_AND_SUM_TIMER(MoveSorting)
     }
 };
+
+/* MovePicker is giving moves one at a time, generating and scoring them only when needed
+ * as most cut-nodes fail high on the TT move or the first capture.
+ * Stages are
+ * 1°) TT move, before any generation (only in qsearch, pvs is trying it itself)
+ * 2°) good captures, in MVV-LVA order, SEE is only computed for the picked capture and bad ones are delayed
+ * 3°) killers and counter, validated with isPseudoLegal
+ * 4°) quiet moves, scored by MoveSorter and lazily sorted
+ * 5°) bad captures
+ * In check and at root, all legal moves are generated (evasions in check), scored by MoveSorter and picked in order (PM_all).
+ * In qsearch only the TT move and captures (without SEE) are given, in probcut only good captures.
+ * Outside of check, checkers and pins are computed when moves are first generated (not for a node cut by its TT move)
+ * and every generated move is then filtered with MoveGen::isLegal, so that no illegal move is applied (legalOnly() is true).
+ * The qsearch TT move, given before that, is validated when applied.
+ * */
+struct MovePicker{
+    enum PickerMode : unsigned char { PM_main = 0, PM_all, PM_qsearch, PM_probcut };
+
+    MovePicker(const Searcher & context, const Position & p, float gp, DepthType ply, const CMHPtrArray & cmhPtr, PickerMode mode, bool isInCheck = false, const TT::Entry * e = NULL, const Move refutation = INVALIDMOVE, const MoveList * moveList = NULL);
+
+    Move next(); // INVALIDMOVE when all moves were given
+    Move peek()const; // probable next move, only if already known without any work (INVALIDMOVE otherwise), for prefetching
+    inline bool legalOnly()const{ return mode == PM_all || li; } // last given move is legal, no need to validate it when applied
+
+private:
+    enum Stage : unsigned char { ST_tt = 0, ST_genCaptures, ST_goodCaptures, ST_killers, ST_genQuiets, ST_quiets, ST_badCaptures, ST_genAll, ST_all, ST_done };
+
+    void initRange(size_t begin, size_t end);
+    void scoreRange(bool mvvLva);
+    Move pickBest();
+    bool alreadyGiven(const Move m)const;
+    inline bool isLegal(const Move m)const{ return !li || MoveGen::isLegal(p,m,*li); }
+
+    const Searcher & context;
+    const Position & p;
+    const MoveSorter sorter;
+    const PickerMode mode;
+    MoveGen::LegalInfo legalInfo;
+    const MoveGen::LegalInfo * li = NULL; // NULL if moves are not filtered (not generated yet, in check, or without king)
+    MoveList moves;
+    Stage stage;
+    size_t cur = 0, end = 0, badEnd = 0, capEnd = 0;
+    unsigned int picked = 0;
+    bool sorted = false;
+    Move ttMove = INVALIDMOVE;
+    Move killers[4] = {INVALIDMOVE,INVALIDMOVE,INVALIDMOVE,INVALIDMOVE};
+    int killerIdx = 0, nbKillers = 0;
+};
@@ -83,9 +83,18 @@ namespace Options {
     void registerCOMOptions(){ // options exposed to GUI
        _keys.push_back(KeyBase(k_int,   w_spin,  "Level"                       , &DynamicConfig::level                          , (unsigned int)0  , (unsigned int)SearchConfig::nlevel ));
        _keys.push_back(KeyBase(k_int,   w_spin,  "Hash"                        , &DynamicConfig::ttSizeMb                       , (unsigned int)1  , (unsigned int)256000                , &TT::initTable));
+       _keys.push_back(KeyBase(k_bool,  w_check, "LargePages"                  , &DynamicConfig::largePages                     , false            , true                                  , &TT::initTable));
+       _keys.push_back(KeyBase(k_bool,  w_check, "NUMAInterleave"              , &DynamicConfig::numaInterleave                 , false            , true                                  , &TT::initTable));
+       _keys.push_back(KeyBase(k_string,w_string,"TTSharedMemory"              , &DynamicConfig::ttSharedName                                                                                , &TT::initTable));
+       _keys.push_back(KeyBase(k_bool,  w_check, "TTTelemetry"                 , &DynamicConfig::ttTelemetry                    , false            , true ));
+       _keys.push_back(KeyBase(k_int,   w_spin,  "PawnHash"                    , &DynamicConfig::ttPawnSizeMb                   , (unsigned int)1  , (unsigned int)1024                  , std::bind(&ThreadPool::initPawnTables, &ThreadPool::instance())));
+       _keys.push_back(KeyBase(k_bool,  w_check, "SharedPawnHash"              , &DynamicConfig::sharedPawnTable                , false            , true                                  , std::bind(&ThreadPool::initPawnTables, &ThreadPool::instance())));
        _keys.push_back(KeyBase(k_int,   w_spin,  "Threads"                     , &DynamicConfig::threads                        , (unsigned int)1  , (unsigned int)256                   , std::bind(&ThreadPool::setup, &ThreadPool::instance())));
+       _keys.push_back(KeyBase(k_int,   w_spin,  "SMPMode"                     , &DynamicConfig::smpMode                        , (unsigned int)0  , (unsigned int)1 ));
+       _keys.push_back(KeyBase(k_bool,  w_check, "Affinity"                    , &DynamicConfig::threadAffinity                 , false            , true                                  , std::bind(&ThreadPool::setup, &ThreadPool::instance())));
        _keys.push_back(KeyBase(k_bool,  w_check, "UCI_Chess960"                , &DynamicConfig::FRC                            , false            , true ));
        _keys.push_back(KeyBase(k_bool,  w_check, "Ponder"                      , &DynamicConfig::UCIPonder                      , false            , true ));
+       _keys.push_back(KeyBase(k_bool,  w_check, "HistoryAging"                , &DynamicConfig::historyAging                   , false            , true ));
        _keys.push_back(KeyBase(k_int,   w_spin,  "MultiPV"                     , &DynamicConfig::multiPV                        , (unsigned int)1  , (unsigned int)4 ));
 
 #ifdef WITH_CLOP_SEARCH
@@ -147,10 +156,19 @@ namespace Options {
        GETOPT(book,             bool)
        GETOPT(bookFile,         std::string)
        GETOPT(ttSizeMb,         unsigned int)
+       GETOPT(largePages,       bool)
+       GETOPT(numaInterleave,   bool)
+       GETOPT(ttSharedName,     std::string)
+       GETOPT(ttTelemetry,      bool)
+       GETOPT(ttPawnSizeMb,     unsigned int)
+       GETOPT(sharedPawnTable,  bool)
        GETOPT(threads,          unsigned int)
+       GETOPT(threadAffinity,   bool)
+       GETOPT(smpMode,          unsigned int)
        GETOPT(mateFinder,       bool)
        GETOPT(fullXboardOutput, bool)
        GETOPT(level,            unsigned int)
+       GETOPT(historyAging,     bool)
 #ifdef WITH_SYZYGY
        GETOPT(syzygyPath,       std::string)
 #endif
@@ -5,6 +5,7 @@
 #include "hash.hpp"
 #include "logging.hpp"
 #include "material.hpp"
+#include "positionTools.hpp"
 
 template < typename T > T readFromString(const std::string & s){ std::stringstream ss(s); T tmp; ss >> tmp; return tmp;}
 
@@ -32,13 +33,13 @@ bool readFEN(const std::string & fen, Position & p, bool silent, bool withMoveCo
         case 'n': p.b[k]= P_bn; break;
         case 'b': p.b[k]= P_bb; break;
         case 'q': p.b[k]= P_bq; break;
-        case 'k': p.b[k]= P_bk; p.king[Co_Black] = k; break;
+        case 'k': p.b[k]= P_bk; break;
         case 'P': p.b[k]= P_wp; break;
         case 'R': p.b[k]= P_wr; break;
         case 'N': p.b[k]= P_wn; break;
         case 'B': p.b[k]= P_wb; break;
         case 'Q': p.b[k]= P_wq; break;
-        case 'K': p.b[k]= P_wk; p.king[Co_White] = k; break;
+        case 'K': p.b[k]= P_wk; break;
         case '/': j--; break;
         case '1': break;
         case '2': j++; break;
@@ -53,7 +54,9 @@ bool readFEN(const std::string & fen, Position & p, bool silent, bool withMoveCo
         j++;
     }
 
-    if ( p.king[Co_White] == INVALIDSQUARE || p.king[Co_Black] == INVALIDSQUARE ) { Logging::LogIt(Logging::logFatal) << "FEN ERROR 0 : missing king" ; return false; }
+    BBTools::setBitBoards(p); // king squares are read from the bitboards
+
+    if ( p.king(Co_White) == INVALIDSQUARE || p.king(Co_Black) == INVALIDSQUARE ) { Logging::LogIt(Logging::logFatal) << "FEN ERROR 0 : missing king" ; return false; }
 
     p.c = Co_White; // set the turn; default is white
     if (strList.size() >= 2){
@@ -78,7 +81,7 @@ bool readFEN(const std::string & fen, Position & p, bool silent, bool withMoveCo
            for ( const char & cr : strList[2] ){
                Logging::LogIt(Logging::logInfo) << cr;
                const Color c = std::isupper(cr) ? Co_White : Co_Black;
-               const char kf = std::toupper(FileNames[SQFILE(p.king[c])].at(0));
+               const char kf = std::toupper(FileNames[SQFILE(p.king(c))].at(0));
                if ( std::toupper(cr) > kf ) { p.castling |= (c==Co_White ? C_wks:C_bks); found = true; }
                else                         { p.castling |= (c==Co_White ? C_wqs:C_bqs); found = true; }
            }
@@ -86,12 +89,10 @@ bool readFEN(const std::string & fen, Position & p, bool silent, bool withMoveCo
         if (strList[2].find('-') != std::string::npos){ found = true; /*Logging::LogIt(Logging::logInfo) << "No castling right given" ;*/}
         if ( ! found ){ if ( !silent) Logging::LogIt(Logging::logWarn) << "No castling right given" ; }
         else{ ///@todo detect illegal stuff in here
-            p.kingInit[Co_White] = p.king[Co_White];
-            p.kingInit[Co_Black] = p.king[Co_Black];
-            if ( p.castling & C_wqs ) { for( Square s = Sq_a1 ; s <= Sq_h1 ; ++s ){ if ( s < p.king[Co_White] && p.b[s]==P_wr ) { p.rooksInit[Co_White][CT_OOO] = s; break; } } }
-            if ( p.castling & C_wks ) { for( Square s = Sq_a1 ; s <= Sq_h1 ; ++s ){ if ( s > p.king[Co_White] && p.b[s]==P_wr ) { p.rooksInit[Co_White][CT_OO]  = s; break; } } }
-            if ( p.castling & C_bqs ) { for( Square s = Sq_a8 ; s <= Sq_h8 ; ++s ){ if ( s < p.king[Co_Black] && p.b[s]==P_br ) { p.rooksInit[Co_Black][CT_OOO] = s; break; } } }
-            if ( p.castling & C_bks ) { for( Square s = Sq_a8 ; s <= Sq_h8 ; ++s ){ if ( s > p.king[Co_Black] && p.b[s]==P_br ) { p.rooksInit[Co_Black][CT_OO]  = s; break; } } }
+            if ( p.castling & C_wqs ) { for( Square s = Sq_a1 ; s <= Sq_h1 ; ++s ){ if ( s < p.king(Co_White) && p.b[s]==P_wr ) { p.rooksInit[Co_White][CT_OOO] = s; break; } } }
+            if ( p.castling & C_wks ) { for( Square s = Sq_a1 ; s <= Sq_h1 ; ++s ){ if ( s > p.king(Co_White) && p.b[s]==P_wr ) { p.rooksInit[Co_White][CT_OO]  = s; break; } } }
+            if ( p.castling & C_bqs ) { for( Square s = Sq_a8 ; s <= Sq_h8 ; ++s ){ if ( s < p.king(Co_Black) && p.b[s]==P_br ) { p.rooksInit[Co_Black][CT_OOO] = s; break; } } }
+            if ( p.castling & C_bks ) { for( Square s = Sq_a8 ; s <= Sq_h8 ; ++s ){ if ( s > p.king(Co_Black) && p.b[s]==P_br ) { p.rooksInit[Co_Black][CT_OO]  = s; break; } } }
         }
     }
     else if ( !silent) Logging::LogIt(Logging::logInfo) << "No castling right given" ;
@@ -114,18 +115,17 @@ bool readFEN(const std::string & fen, Position & p, bool silent, bool withMoveCo
     else p.fifty = 0;
 
     // read number of move
-    if (withMoveCount && strList.size() >= 6) p.moves = (unsigned char)readFromString<int>(strList[5]);
-    else p.moves = 1;
+    int moves = 1;
+    if (withMoveCount && strList.size() >= 6) moves = (unsigned char)readFromString<int>(strList[5]);
 
-    if (p.moves < 1) { // fix a LittleBlitzer bug here ...
-        Logging::LogIt(Logging::logWarn) << "Wrong move counter " << (int)p.moves << " using 1 instead";
-        p.moves = 1;
+    if (moves < 1) { // fix a LittleBlitzer bug here ...
+        Logging::LogIt(Logging::logWarn) << "Wrong move counter " << moves << " using 1 instead";
+        moves = 1;
     }
 
-    p.halfmoves = (int(p.moves) - 1) * 2 + 1 + (p.c == Co_Black ? 1 : 0);
-
-    BBTools::setBitBoards(p);
+    p.halfmoves = (moves - 1) * 2 + 1 + (p.c == Co_Black ? 1 : 0); // the move counter is derived from it
     MaterialHash::initMaterial(p);
+    p.psqt = computePSQT(p);
     p.h = computeHash(p);
     p.ph = computePHash(p);
     return true;
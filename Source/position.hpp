@@ -1,6 +1,8 @@
 #pragma once
 
 #include "definition.hpp"
+#include "bitboard.hpp"
+#include "score.hpp"
 
 struct Position; // forward decl
 bool readFEN(const std::string & fen, Position & p, bool silent = false, bool withMoveount = false); // forward decl
@@ -10,12 +12,17 @@ bool readFEN(const std::string & fen, Position & p, bool silent = false, bool wi
  *  - board
  *  - all bitboards
  *  - material
+ *  - PST score (incrementally updated, white point of view)
  *  - hash (full position and just K+P)
  *  - some game status info
  *
  *  Contains also some usefull accessor
  *
  * Minic is a copy/make engine, so that this structure is copied a lot !
+ * (see WITH_MAKE_UNMAKE for the make/unmake alternative, using an UndoInfo record)
+ * Initial king square is not stored, while castling is possible the king is still on it.
+ * King squares are read from the king bitboards and the move counter from halfmoves.
+ * Members are ordered by alignment so that there is no padding (248 bytes).
  */
 struct Position{
     std::array<Piece,64>    b    {{ P_none }}; // works because P_none is in fact 0 ...
@@ -25,15 +32,18 @@ struct Position{
     BitBoard allPieces[2] = {empty};
     BitBoard occupancy    = empty;
 
+    mutable Hash h = nullHash, ph = nullHash;
+    Move lastMove = INVALIDMOVE;
+
     // t p n b r q k bl bd M n  (total is first so that pawn to king is same a Piece)
     typedef std::array<std::array<char,11>,2> Material;
     Material mat = {{{{0}}}}; // such a nice syntax ...
 
-    mutable Hash h = nullHash, ph = nullHash;
-    Move lastMove = INVALIDMOVE;
-    Square ep = INVALIDSQUARE, king[2] = { INVALIDSQUARE, INVALIDSQUARE }, rooksInit[2][2] = { {INVALIDSQUARE, INVALIDSQUARE}, {INVALIDSQUARE, INVALIDSQUARE}}, kingInit[2] = {INVALIDSQUARE, INVALIDSQUARE};
+    EvalScore psqt;
+
+    unsigned short int halfmoves = 0;
+    Square ep = INVALIDSQUARE, rooksInit[2][2] = { {INVALIDSQUARE, INVALIDSQUARE}, {INVALIDSQUARE, INVALIDSQUARE}};
     unsigned char fifty = 0;
-    unsigned short int moves = 0, halfmoves = 0;
     CastlingRights castling = C_none;
     Color c = Co_White;
 
@@ -54,6 +64,9 @@ struct Position{
     inline const BitBoard & pieces(Color c)const{ return allB[(1-2*c)*pp+PieceShift]; }
     inline const BitBoard & pieces(Color c, Piece pp)const{ return allB[(1-2*c)*pp+PieceShift]; }
 
+    inline Square king(Color c)const{ const BitBoard & k = pieces<P_wk>(c); return k ? Square(BitScanForward(k)) : INVALIDSQUARE; }
+    inline unsigned short int moves()const{ return (halfmoves + 1 - c) / 2; } // halfmoves is 1 on white first move
+
     Position(){}
     Position(const std::string & fen, bool withMoveCount = true){readFEN(fen,*this,true,withMoveCount);}
 };
@@ -42,7 +42,7 @@ std::string GetFENShort2(const Position &p) { // "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/
 
 std::string GetFEN(const Position &p) { // "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d5 0 2"
     std::stringstream ss;
-    ss << GetFENShort2(p) << " " << (int)p.fifty << " " << (int)p.moves;
+    ss << GetFENShort2(p) << " " << (int)p.fifty << " " << (int)p.moves();
     return ss.str();
 }
 
@@ -60,7 +60,7 @@ Move SanitizeCastling(const Position & p, const Move & m){
     // convert GUI castling input notation to internal castling style if not FRC
     if ( !DynamicConfig::FRC ){
        bool whiteToMove = p.c == Co_White;
-       if (mtype == T_std && from == p.kingInit[p.c] ) {
+       if (mtype == T_std && from == p.king(p.c) && (p.castling & (whiteToMove ? (C_wqs|C_wks) : (C_bqs|C_bks))) ) {
            if      (to == (whiteToMove ? Sq_c1 : Sq_c8)) return ToMove(from, to, whiteToMove ? T_wqs : T_bqs);
            else if (to == (whiteToMove ? Sq_g1 : Sq_g8)) return ToMove(from, to, whiteToMove ? T_wks : T_bks);
        }
@@ -69,7 +69,7 @@ Move SanitizeCastling(const Position & p, const Move & m){
 }
 
 Square kingSquare(const Position & p) {
-  return p.king[p.c];
+  return p.king(p.c);
 }
 
 bool readMove(const Position & p, const std::string & ss, Square & from, Square & to, MType & moveType ) {
@@ -149,6 +149,13 @@ bool readMove(const Position & p, const std::string & ss, Square & from, Square
     return true;
 }
 
+EvalScore computePSQT(const Position & p){
+    EvalScore score;
+    BitBoard pieces = p.occupancy;
+    while (pieces) { const Square k = popBit(pieces); score += PSQT(p.b[k],k); }
+    return score;
+}
+
 float gamePhase(const Position & p, ScoreType & matScoreW, ScoreType & matScoreB){
     const float totalMatScore = 2.f * *absValues[P_wq] + 4.f * *absValues[P_wr] + 4.f * *absValues[P_wb] + 4.f * *absValues[P_wn] + 16.f * *absValues[P_wp]; // cannot be static for tuning process ...
     const ScoreType matPieceScoreW = p.mat[Co_White][M_q] * *absValues[P_wq] + p.mat[Co_White][M_r] * *absValues[P_wr] + p.mat[Co_White][M_b] * *absValues[P_wb] + p.mat[Co_White][M_n] * *absValues[P_wn];
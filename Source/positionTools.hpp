@@ -1,6 +1,7 @@
 #pragma once
 
 #include "definition.hpp"
+#include "evalConfig.hpp"
 #include "position.hpp"
 
 std::string GetFENShort(const Position &p );
@@ -18,3 +19,9 @@ Square kingSquare(const Position & p);
 bool readMove(const Position & p, const std::string & ss, Square & from, Square & to, MType & moveType );
 
 float gamePhase(const Position & p, ScoreType & matScoreW, ScoreType & matScoreB);
+
+// PST value of a piece on a square (white point of view)
+inline EvalScore PSQT(Piece pp, Square k){ return pp > 0 ? EvalConfig::PST[pp-1][k^56] : pp < 0 ? EvalScore() - EvalConfig::PST[-pp-1][k] : EvalScore(); }
+
+// full PST computation, p.psqt is otherwise incrementally updated by apply
+EvalScore computePSQT(const Position & p);
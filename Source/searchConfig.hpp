@@ -56,6 +56,8 @@ const int nlevel = 100;
 const DepthType levelDepthMax[nlevel/10+1]   = {0,1,1,2,4,6,8,10,12,14,MAX_DEPTH};
 
 const DepthType lmpMaxDepth = 10;
+
+const DepthType abdadaMinDepth = 3; // moves are not deferred near the leaves, that would cost more than it saves
 const int lmpLimit[][SearchConfig::lmpMaxDepth + 1] = { { 0, 3, 4, 6, 10, 15, 21, 28, 36, 45, 55 }, { 0, 5, 6, 9, 15, 23, 32, 42, 54, 68, 83 } };
 
 extern DepthType lmrReduction[MAX_DEPTH][MAX_MOVE];
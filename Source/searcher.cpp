@@ -1,6 +1,8 @@
 #include "searcher.hpp"
 
 #include "logging.hpp"
+#include "moveGen.hpp"
+#include "transposition.hpp"
 
 TimeType Searcher::getCurrentMoveMs() {
     if (TimeMan::isUCIPondering) {
@@ -19,12 +21,26 @@ TimeType Searcher::getCurrentMoveMs() {
     return std::max(ret, TimeType(20));// if not much time left, let's try that ...;
 }
 
+void Searcher::timeCheck(){
+    nodesSinceTimeCheck = 0;
+    if ( !isMainThread() ) return;
+    const TimeType allowedMs = getCurrentMoveMs(); // first, as the budget is changing on ponderhit
+    if ( (TimeType)std::max(1, (int)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - TimeMan::budgetStart()).count()) > allowedMs ){
+        stopFlag = true;
+        Logging::LogIt(Logging::logInfo) << "stopFlag triggered (time)";
+    }
+    else if ( TimeMan::maxKNodes > 0 && (ThreadPool::instance().counter(Stats::sid_nodes) + ThreadPool::instance().counter(Stats::sid_qnodes))/1000 >= TimeMan::maxKNodes ){
+        stopFlag = true;
+        Logging::LogIt(Logging::logInfo) << "stopFlag triggered (nodes limit)";
+    }
+}
+
 void Searcher::getCMHPtr(DepthType ply, CMHPtrArray & cmhPtr){
     cmhPtr.fill(0);
     for( int k = 0 ; k < MAX_CMH_PLY ; ++k){
-        if( ply > k && VALIDMOVE(stack[ply-k].p.lastMove)){
-           const Square to = Move2To(stack[ply-k].p.lastMove);
-           cmhPtr[k] = historyT.counter_history[stack[ply-k-1].p.b[to]+PieceShift][to];
+        if( ply > k && VALIDMOVE(stack[ply-k].lastMove)){
+           const Square to = Move2To(stack[ply-k].lastMove);
+           cmhPtr[k] = historyT.counterHistory(stack[ply-k].lastMoveToPiece,to);
         }
     }
 }
@@ -45,10 +61,18 @@ void Searcher::idleLoop(){
         _cv.wait(lock, [&]{ return _searching; });
         if (_exit) return;
         lock.unlock();
-        search();
+        if ( _task ){ _task(); _task = nullptr; }
+        else search();
     }
 }
 
+void Searcher::runTask(const std::function<void(void)> & task){
+    std::lock_guard<std::mutex> lock(_mutex);
+    _task = task;
+    _searching = true;
+    _cv.notify_one(); // Wake up the thread in IdleLoop()
+}
+
 void Searcher::start(){
     std::lock_guard<std::mutex> lock(_mutex);
     Logging::LogIt(Logging::logInfo) << "Starting worker " << id() ;
@@ -61,10 +85,35 @@ void Searcher::wait(){
     _cv.wait(lock, [&]{ return !_searching; });
 }
 
+namespace{
+std::mutex              startMutex;
+std::condition_variable startCV;
+bool                    startLocked = false;
+}
+
+void Searcher::lockStart(){
+    std::lock_guard<std::mutex> lock(startMutex);
+    startLocked = true;
+}
+
+void Searcher::releaseStart(){
+    {
+        std::lock_guard<std::mutex> lock(startMutex);
+        if ( !startLocked ) return;
+        startLocked = false;
+    }
+    startCV.notify_all();
+}
+
+void Searcher::waitStart(){
+    std::unique_lock<std::mutex> lock(startMutex);
+    startCV.wait(lock, []{ return !startLocked; });
+}
+
 void Searcher::search(){
     Logging::LogIt(Logging::logInfo) << "Search launched for thread " << id() ;
     if ( isMainThread() ){ ThreadPool::instance().startOthers(); } // started other threads but locked for now ...
-    _data.pv = search(_data.p, _data.best, _data.depth, _data.sc, _data.seldepth);
+    _data.pv = search(_data.p, _data.best, _data.depth, _data.sc, _data.seldepth, &_data.history);
 }
 
 size_t Searcher::id()const {
@@ -86,6 +135,20 @@ Searcher::~Searcher(){
     _stdThread.join();
 }
 
+void * Searcher::operator new(size_t size){
+    return Allocator::alloc(size, DynamicConfig::largePages);
+}
+
+void Searcher::operator delete(void * ptr){
+    Allocator::free(ptr);
+}
+
+void Searcher::clearGame(){
+    killerT.initKillers();
+    historyT.initHistory();
+    counterT.initCounter();
+}
+
 void Searcher::setData(const ThreadData & d){
     _data = d;
 }
@@ -98,21 +161,68 @@ bool Searcher::searching()const{
     return _searching;
 }
 
+namespace{
+unsigned long long int pawnTableSize(size_t sizeMb){ // largest power of 2 number of entries fitting in sizeMb
+    const unsigned long long int n = (unsigned long long int)sizeMb*1024*1024/sizeof(Searcher::PawnEntry);
+    unsigned long long int size = 1;
+    while (2*size <= n) size *= 2;
+    return size;
+}
+
+MiniHash pawnChecksum(const Searcher::PawnEntry & pe){ // xor of everything but the key
+    const BitBoard * bb = &pe.pawnTargets[0];
+    BitBoard c = 0;
+    for (int k = 0; k < 9; ++k) c ^= bb[k];
+    c ^= (BitBoard(uint16_t(pe.score[MG])) << 48) ^ (BitBoard(uint16_t(pe.score[EG])) << 32) ^ (BitBoard(uint16_t(pe.danger[0])) << 16) ^ BitBoard(uint16_t(pe.danger[1]));
+    return MiniHash(c ^ (c >> 32));
+}
+} // anonymous
+
 void Searcher::initPawnTable(){
-    assert(tablePawn==0);
-    assert(ttSizePawn>0);
+    tablePawn.reset();
+    ttSizePawn = 0;
+    if ( DynamicConfig::sharedPawnTable ) return;
+    ttSizePawn = pawnTableSize(DynamicConfig::ttPawnSizeMb);
     Logging::LogIt(Logging::logInfo) << "Init Pawn TT : " << ttSizePawn;
     Logging::LogIt(Logging::logInfo) << "PawnEntry size " << sizeof(PawnEntry);
-    tablePawn.reset(new PawnEntry[ttSizePawn]);
+    tablePawn.reset((PawnEntry*)Allocator::alloc(ttSizePawn*sizeof(PawnEntry), DynamicConfig::largePages));
+    clearPawnTT();
     Logging::LogIt(Logging::logInfo) << "Size of Pawn TT " << ttSizePawn * sizeof(PawnEntry) / 1024 / 1024 << "Mb" ;
 }
 
+void Searcher::initPawnTableShared(size_t nbThreads){
+    tablePawnShared.reset();
+    ttSizePawnShared = 0;
+    if ( nbThreads == 0 ) return;
+    ttSizePawnShared = pawnTableSize(DynamicConfig::ttPawnSizeMb*nbThreads);
+    Logging::LogIt(Logging::logInfo) << "Init shared Pawn TT : " << ttSizePawnShared;
+    tablePawnShared.reset((PawnEntry*)Allocator::alloc(ttSizePawnShared*sizeof(PawnEntry), DynamicConfig::largePages, DynamicConfig::numaInterleave ? Allocator::numa_interleave : Allocator::numa_firstTouch));
+    Logging::LogIt(Logging::logInfo) << "Size of shared Pawn TT " << ttSizePawnShared * sizeof(PawnEntry) / 1024 / 1024 << "Mb" ;
+}
+
+void Searcher::clearPawnTableShared(size_t id, size_t n){
+    if ( !tablePawnShared ) return;
+    const unsigned long long int slice = (ttSizePawnShared + n - 1) / n;
+    const unsigned long long int first = std::min(ttSizePawnShared, id*slice);
+    const unsigned long long int last  = std::min(ttSizePawnShared, first + slice);
+    for (unsigned long long int k = first; k < last; ++k) tablePawnShared[k] = PawnEntry();
+}
+
 void Searcher::clearPawnTT() {
-    for (unsigned int k = 0; k < ttSizePawn; ++k) tablePawn[k].h = 0;
+    for (unsigned int k = 0; k < ttSizePawn; ++k) tablePawn[k] = PawnEntry();
 }
 
 bool Searcher::getPawnEntry(Hash h, PawnEntry *& pe){
     assert(h > 0);
+    if ( ttSizePawn == 0 ){ // shared table, work on a local copy
+        assert(tablePawnShared);
+        pawnScratch = tablePawnShared[h&(ttSizePawnShared-1)];
+        pe = &pawnScratch;
+        if ( (pawnScratch.h ^ pawnChecksum(pawnScratch)) != Hash64to32(h) ) return false;
+        pawnScratch.h = Hash64to32(h);
+        ++stats.counters[Stats::sid_ttPawnhits];
+        return true;
+    }
     PawnEntry & _e = tablePawn[h&(ttSizePawn-1)];
     pe = &_e;
     if ( _e.h != Hash64to32(h) )     return false;
@@ -120,8 +230,47 @@ bool Searcher::getPawnEntry(Hash h, PawnEntry *& pe){
     return true;
 }
 
+void Searcher::setPawnEntry(Hash h, PawnEntry & pe){
+    ++stats.counters[Stats::sid_ttPawnInsert];
+    pe.h = Hash64to32(h);
+    if ( ttSizePawn == 0 ){ // shared table, pe is the local copy
+        PawnEntry & _e = tablePawnShared[h&(ttSizePawnShared-1)];
+        _e = pe;
+        _e.h = pe.h ^ pawnChecksum(pe);
+    }
+}
+
+void Searcher::initEvalTable(){
+    tableEval.reset((EvalEntry*)Allocator::alloc(ttSizeEval*sizeof(EvalEntry), DynamicConfig::largePages));
+    for (unsigned int k = 0; k < ttSizeEval; ++k) tableEval[k] = EvalEntry();
+    Logging::LogIt(Logging::logInfo) << "Size of eval cache " << ttSizeEval * sizeof(EvalEntry) / 1024 << "Kb" ;
+}
+
+// weakened levels randomize the eval, such scores shall not be cached and reused as if they were exact
+bool Searcher::getEvalEntry(Hash h, ScoreType & score, EvalData & data){
+    if ( DynamicConfig::disableTT || DynamicConfig::level != SearchConfig::nlevel ) return false;
+    const EvalEntry & _e = tableEval[h&(ttSizeEval-1)];
+    if ( _e.h != h ){ ++stats.counters[Stats::sid_evalCacheMiss]; return false; }
+    ++stats.counters[Stats::sid_evalCacheHits];
+    score = _e.score;
+    data.gp = _e.gp;
+    data.danger[Co_White] = _e.danger[Co_White];
+    data.danger[Co_Black] = _e.danger[Co_Black];
+    return true;
+}
+
+void Searcher::setEvalEntry(Hash h, ScoreType score, const EvalData & data){
+    if ( DynamicConfig::disableTT || DynamicConfig::level != SearchConfig::nlevel ) return;
+    EvalEntry & _e = tableEval[h&(ttSizeEval-1)];
+    _e.h = h;
+    _e.gp = data.gp;
+    _e.score = score;
+    _e.danger[Co_White] = data.danger[Co_White];
+    _e.danger[Co_Black] = data.danger[Co_Black];
+}
+
 void Searcher::prefetchPawn(Hash h) {
-    void * addr = (&tablePawn[h&(ttSizePawn-1)]);
+    void * addr = ttSizePawn == 0 ? (&tablePawnShared[h&(ttSizePawnShared-1)]) : (&tablePawn[h&(ttSizePawn-1)]);
     #  if defined(__INTEL_COMPILER)
     __asm__ ("");
     #  elif defined(_MSC_VER)
@@ -131,8 +280,21 @@ void Searcher::prefetchPawn(Hash h) {
     #  endif
 }
 
-bool Searcher::stopFlag           = true;
+void Searcher::prefetchChild(const Position & p, const Move m) {
+    TT::prefetch(keyAfter(p,m));
+    const Square from = Move2From(m);
+    const Square to   = Move2To(m);
+    const MType type  = Move2Type(m);
+    if ( std::abs(p.b[from]) == P_wp || std::abs(p.b[from]) == P_wk || std::abs(p.b[to]) == P_wp ) prefetchPawn(pawnKeyAfter(p,m));
+    if ( isCapture(type) && !isPromotion(type) ){
+        const Hash matHash = MaterialHash::getMaterialHashAfterCapture(p, type == T_ep ? Square(p.ep + (p.c == Co_White ? -8 : +8)) : to);
+        if ( matHash != nullHash ) MaterialHash::prefetch(matHash);
+    }
+}
+
+std::atomic<bool> Searcher::stopFlag(true);
 TimeType  Searcher::currentMoveMs = 777; // a dummy initial value, useful for debug
 MoveDifficultyUtil::MoveDifficulty Searcher::moveDifficulty = MoveDifficultyUtil::MD_std;
-std::atomic<bool> Searcher::startLock;
-const unsigned long long int Searcher::ttSizePawn = 1024*32;
+const unsigned long long int Searcher::ttSizeEval = 1024*64;
+unsigned long long int Searcher::ttSizePawnShared = 0;
+std::unique_ptr<Searcher::PawnEntry[],Allocator::Deleter> Searcher::tablePawnShared;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "allocator.hpp"
 #include "evalDef.hpp"
 #include "material.hpp"
 #include "score.hpp"
@@ -14,17 +15,24 @@
  * Many things are templates here, so other hpp file are included at the bottom of this one.
  */
 struct Searcher{
-    static bool stopFlag;
+    static std::atomic<bool> stopFlag;
     static MoveDifficultyUtil::MoveDifficulty moveDifficulty;
     static TimeType currentMoveMs;
     static TimeType getCurrentMoveMs(); // use this (and not the variable) to take emergency time into account !
 
+    // time and node limits are polled by the main thread every timeCheckNodes nodes, not at every node
+    static const Counter timeCheckNodes = 1024;
+    Counter nodesSinceTimeCheck = 0;
+    void timeCheck();
+
     struct StackData{
        Hash h = nullHash;
        ScoreType eval = 0;
        EvalData data = { 0, {0,0} };
        Move threat = INVALIDMOVE;
-       Position p;
+       Move lastMove = INVALIDMOVE; // move leading to this node
+       Piece lastMoveToPiece = P_none; // what was on the destination square of lastMove before it was played (CMH)
+       PVList pv; // pv of the node at this halfmove, so that the search is not allocating
     };
     std::array<StackData,MAX_PLY> stack;
 
@@ -32,10 +40,10 @@ struct Searcher{
 
     // used for easy move detection
     struct RootScores { Move m; ScoreType s; };
-    std::vector<RootScores> rootScores;
+    OptList<RootScores,MAX_MOVE> rootScores; // cleared at root node entry
 
     // used for move ordering
-    Move previousBest;
+    Move previousBest = INVALIDMOVE;
 
     KillerT killerT;
     HistoryT historyT;
@@ -47,14 +55,15 @@ struct Searcher{
 
     ScoreType drawScore();
 
-    template <bool pvnode, bool canPrune = true> ScoreType pvs(ScoreType alpha, ScoreType beta, const Position & p, DepthType depth, unsigned int ply, PVList & pv, DepthType & seldepth, bool isInCheck, bool cutNode, const std::vector<MiniMove> * skipMoves = nullptr);
+    template <bool pvnode, bool canPrune = true> ScoreType pvs(ScoreType alpha, ScoreType beta, const Position & p, DepthType depth, unsigned int ply, PVList & pv, DepthType & seldepth, bool isInCheck, bool cutNode, const SkipList * skipMoves = nullptr);
     template <bool qRoot, bool pvnode> ScoreType qsearch(ScoreType alpha, ScoreType beta, const Position & p, unsigned int ply, DepthType & seldepth);
     ScoreType qsearchNoPruning(ScoreType alpha, ScoreType beta, const Position & p, unsigned int ply, DepthType & seldepth);
     bool SEE_GE(const Position & p, const Move & m, ScoreType threshold)const;
     ScoreType SEE(const Position & p, const Move & m)const;
-    PVList search(const Position & p, Move & m, DepthType & d, ScoreType & sc, DepthType & seldepth);
+    PVList search(const Position & p, Move & m, DepthType & d, ScoreType & sc, DepthType & seldepth, const std::vector<Hash> * history = nullptr);
     template< bool withRep = true, bool isPv = true, bool INR = true> MaterialHash::Terminaison interiorNodeRecognizer(const Position & p)const;
     bool isRep(const Position & p, bool isPv)const;
+    bool hasUpcomingRep(const Position & p, unsigned int ply)const;
     static void displayGUI(DepthType depth, DepthType seldepth, ScoreType bestScore, const PVList & pv, int multipv, const std::string & mark = "");
 
     void idleLoop();
@@ -65,6 +74,9 @@ struct Searcher{
 
     void search();
 
+    // run a task on this thread instead of a search (used to share work such as TT clearing)
+    void runTask(const std::function<void(void)> & task);
+
     size_t id()const;
     bool   isMainThread()const;
 
@@ -72,10 +84,20 @@ struct Searcher{
 
     ~Searcher();
 
+    // Searcher is big (stack and history tables), so it is allocated on huge pages if possible
+    static void * operator new(size_t size);
+    static void operator delete(void * ptr);
+
+    // reset everything learned during the current game (history, counter and killer tables)
+    void clearGame();
+
     void setData(const ThreadData & d);
     const ThreadData & getData()const;
 
-    static std::atomic<bool> startLock;
+    // helper threads wait here until the main thread allows them to start (after its first iterations)
+    static void lockStart();
+    static void releaseStart();
+    static void waitStart();
 
     bool searching()const;
 
@@ -96,17 +118,51 @@ struct Searcher{
     };
     #pragma pack(pop)
 
-    static const unsigned long long int ttSizePawn;
-    std::unique_ptr<PawnEntry[]> tablePawn = 0;
+    // private table of this thread, unused if the shared pawn table is used
+    unsigned long long int ttSizePawn = 0;
+    std::unique_ptr<PawnEntry[],Allocator::Deleter> tablePawn;
+
+    // table shared by all threads, entries are validated locklessly :
+    // key is stored xored with a checksum of the data, so that a torn entry is seen as a miss
+    static unsigned long long int ttSizePawnShared;
+    static std::unique_ptr<PawnEntry[],Allocator::Deleter> tablePawnShared;
+    PawnEntry pawnScratch; // local copy of a shared entry
 
     void initPawnTable();
 
+    static void initPawnTableShared(size_t nbThreads); // no shared table if nbThreads is 0
+
+    static void clearPawnTableShared(size_t id, size_t n); // clear slice id over n of the shared table
+
     void clearPawnTT();
 
+    // pe points to the entry to be used (filled if found, to be filled and given to setPawnEntry if not)
     bool getPawnEntry(Hash h, PawnEntry *& pe);
 
+    void setPawnEntry(Hash h, PawnEntry & pe);
+
     void prefetchPawn(Hash h);
 
+    // prefetch TT, pawn and material entries of the position after m (m is not applied)
+    void prefetchChild(const Position & p, const Move m);
+
+    // small per thread static evaluation cache, independent of the TT
+    struct EvalEntry{
+        Hash h          = nullHash;
+        float gp        = 0;
+        ScoreType score = 0;
+        ScoreType danger[2] = {0,0};
+    };
+
+    static const unsigned long long int ttSizeEval;
+    std::unique_ptr<EvalEntry[],Allocator::Deleter> tableEval;
+
+    void initEvalTable();
+
+    bool getEvalEntry(Hash h, ScoreType & score, EvalData & data);
+
+    void setEvalEntry(Hash h, ScoreType score, const EvalData & data);
+
 private:
     ThreadData              _data;
     size_t                  _index;
@@ -116,6 +172,7 @@ private:
     // next two MUST be initialized BEFORE _stdThread
     bool                    _exit;
     bool                    _searching;
+    std::function<void(void)> _task;
     std::thread             _stdThread;
 };
 
@@ -1,5 +1,7 @@
 #include "searcher.hpp"
 
+#include "attack.hpp"
+#include "hash.hpp"
 #include "position.hpp"
 
 bool Searcher::isRep(const Position & p, bool isPV)const{
@@ -7,10 +9,43 @@ bool Searcher::isRep(const Position & p, bool isPV)const{
     if ( p.fifty < (2*limit-1) ) return false;
     int count = 0;
     const Hash h = computeHash(p);
-    for (int k = p.halfmoves - 1; k >= 0; --k) {
+    // only same side to move and inside the fifty move window (older positions cannot be the same)
+    for (int k = p.halfmoves - 2; k >= std::max(0, p.halfmoves - p.fifty); k -= 2) {
         if (stack[k].h == nullHash) break;
         if (stack[k].h == h) ++count;
         if (count >= limit) return true;
     }
     return false;
 }
+
+// Is there a move, for the side to move, that goes back to a position already in the history ?
+// Based on the cuckoo tables (see Marcel van Kervinck paper and Stockfish implementation)
+bool Searcher::hasUpcomingRep(const Position & p, unsigned int ply)const{
+    const int end = std::min(int(p.fifty), int(p.halfmoves));
+    if ( end < 3 ) return false;
+    const Hash h = computeHash(p);
+    for (int i = 1; i <= end; ++i) {
+        const int k = p.halfmoves - i;
+        if ( i <= int(ply) && stack[k+1].lastMove == NULLMOVE ) return false; // no repetition through a null move
+        if ( stack[k].h == nullHash ) return false;
+        if ( i < 3 || !(i&1) ) continue; // the position reached shall have the other side to move
+        const Hash moveKey = h ^ stack[k].h;
+        int j = Cuckoo::h1(moveKey);
+        if ( Cuckoo::keys[j] != moveKey ){
+            j = Cuckoo::h2(moveKey);
+            if ( Cuckoo::keys[j] != moveKey ) continue;
+        }
+        const Square s1 = Move2From(Cuckoo::moves[j]);
+        const Square s2 = Move2To(Cuckoo::moves[j]);
+        if ( BBTools::mask[s1].between[s2] & p.occupancy ) continue; // move is not possible
+        const Piece pp = p.b[p.b[s1] != P_none ? s1 : s2];
+        if ( (pp > 0) != (p.c == Co_White) ) continue; // this is the opponent piece
+        if ( i < int(ply) ) return true; // inside the search tree, one repetition is enough
+        // before the root, the reached position shall already be a repetition
+        for (int l = k - 2; l >= std::max(0, p.halfmoves - end); l -= 2) {
+            if ( stack[l].h == nullHash ) break;
+            if ( stack[l].h == stack[k].h ) return true;
+        }
+    }
+    return false;
+}
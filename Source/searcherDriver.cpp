@@ -1,6 +1,7 @@
 #include "searcher.hpp"
 
 #include "book.hpp"
+#include "com.hpp"
 #include "logging.hpp"
 
 namespace{
@@ -27,19 +28,26 @@ void Searcher::displayGUI(DepthType depth, DepthType seldepth, ScoreType bestSco
         str << "info " << "multipv " << multipv << " depth " << int(depth) << " score cp " << bestScore << " time " << ms << " nodes " << nodeCount << " nps " << int(nodeCount / (ms / 1000.f)) << " seldepth " << (int)seldepth << " pv " << ToString(pv) << " tbhits " << ThreadPool::instance().counter(Stats::sid_tbHit1) + ThreadPool::instance().counter(Stats::sid_tbHit2);
         static auto lastHashFull = Clock::now();
         if (  (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - lastHashFull).count() > 500
-              && (TimeType)std::max(1, int(std::chrono::duration_cast<std::chrono::milliseconds>(now - TimeMan::startTime).count()*2)) < getCurrentMoveMs()
+              && (TimeType)std::max(1, int(std::chrono::duration_cast<std::chrono::milliseconds>(now - TimeMan::budgetStart()).count()*2)) < getCurrentMoveMs()
               && !stopFlag){
             lastHashFull = now;
             str << " hashfull " << TT::hashFull();
         }
     }
     Logging::LogIt(Logging::logGUI) << str.str();
+    COM::firstInfoSent();
 }
 
-PVList Searcher::search(const Position & p, Move & m, DepthType & d, ScoreType & sc, DepthType & seldepth){
+PVList Searcher::search(const Position & pInit, Move & m, DepthType & d, ScoreType & sc, DepthType & seldepth, const std::vector<Hash> * history){
+#ifdef WITH_MAKE_UNMAKE
+    Position p = pInit; // moves are made and unmade on this copy, the given position may be shared between threads
+#else
+    const Position & p = pInit;
+#endif
     d=std::max((DepthType)1,DynamicConfig::level==SearchConfig::nlevel?d:std::min(d,SearchConfig::levelDepthMax[DynamicConfig::level/10]));
     if ( isMainThread() ){
         TimeMan::startTime = Clock::now();
+        TimeMan::setBudgetStart(TimeMan::startTime);
         Logging::LogIt(Logging::logInfo) << "Search params :" ;
         Logging::LogIt(Logging::logInfo) << "requested time  " << getCurrentMoveMs() ;
         Logging::LogIt(Logging::logInfo) << "requested depth " << (int) d ;
@@ -50,15 +58,26 @@ PVList Searcher::search(const Position & p, Move & m, DepthType & d, ScoreType &
     }
     else{
         Logging::LogIt(Logging::logInfo) << "helper thread waiting ... " << id() ;
-        while(startLock.load()){;}
+        waitStart();
         Logging::LogIt(Logging::logInfo) << "... go for id " << id() ;
     }
     stats.init();
     //clearPawnTT(); ///@todo loop context
-    killerT.initKillers();
-    historyT.initHistory();
-    counterT.initCounter();
+    killerT.initKillers(); // killers are indexed by ply, they are meaningless in the next search
+    if ( DynamicConfig::historyAging ) historyT.ageHistory(); // counter moves are kept as is
+    else{
+        historyT.initHistory();
+        counterT.initCounter();
+    }
+    previousBest = INVALIDMOVE; // shall not leak from a previous search (in another position)
 
+    // slots before the root are filled from the game history inside the fifty move window (that is all repetition detection reads),
+    // without history they are reset so that they do not hold positions of a previous search
+    const int historySize = history ? (int)history->size() : 0;
+    for (int k = std::max(0, p.halfmoves - p.fifty); k < p.halfmoves; ++k){
+        const int i = historySize - (p.halfmoves - k);
+        stack[k].h = i >= 0 ? (*history)[i] : nullHash;
+    }
     stack[p.halfmoves].h = p.h;
 
     DepthType reachedDepth = 0;
@@ -69,7 +88,7 @@ PVList Searcher::search(const Position & p, Move & m, DepthType & d, ScoreType &
     if ( isMainThread() ){
        const Move bookMove = SanitizeCastling(p,Book::Get(computeHash(p)));
        if ( bookMove != INVALIDMOVE){
-           if ( isMainThread() ) startLock.store(false);
+           if ( isMainThread() ) releaseStart();
            pv.push_back(bookMove);
            m = pv[0];
            d = 0;
@@ -105,14 +124,14 @@ PVList Searcher::search(const Position & p, Move & m, DepthType & d, ScoreType &
     // ID loop
     for(DepthType depth = startDepth ; depth <= std::min(d,DepthType(MAX_DEPTH-6)) && !stopFlag ; ++depth ){ // -6 so that draw can be found for sure ///@todo I don't understand this -6 anymore ..
         // MultiPV loop
-        std::vector<MiniMove> skipMoves;
+        SkipList skipMoves;
         for (unsigned int multi = 0 ; multi < (Logging::ct == Logging::CT_uci?DynamicConfig::multiPV:1) ; ++multi){
             if ( !skipMoves.empty() && isMatedScore(bestScore) ) break;
-            if (!isMainThread()){ // stockfish like thread management
+            if (!isMainThread() && DynamicConfig::smpMode == DynamicConfig::smp_lazy){ // stockfish like thread management (ABDADA threads all search the same depth)
                 const int i = (id()-1)%threadSkipSize;
                 if (((depth + skipPhase[i]) / skipSize[i]) % 2) continue;
             }
-            else{ if ( depth > 1) startLock.store(false);} // delayed other thread start
+            else{ if ( depth > 1) releaseStart();} // delayed other thread start
             Logging::LogIt(Logging::logInfo) << "Thread " << id() << " searching depth " << (int)depth;
             PVList pvLoc;
             ScoreType delta = (SearchConfig::doWindow && depth>4)?6+std::max(0,(20-depth)*2):MATE; // MATE not INFSCORE in order to enter the loop below once ///@todo try delta function of depth
@@ -124,7 +143,14 @@ PVList Searcher::search(const Position & p, Move & m, DepthType & d, ScoreType &
             while( true && !stopFlag ){
                 pvLoc.clear();
                 stack[p.halfmoves].h = p.h;
+#ifdef DEBUG_HEAP
+                const Counter heapAllocBefore = heapAllocCount;
+#endif
                 score = pvs<true,false>(alpha,beta,p,windowDepth,0,pvLoc,seldepth,isInCheck,false,skipMoves.empty()?nullptr:&skipMoves);
+#ifdef DEBUG_HEAP
+                // stopping the search may log things, so only a complete search is checked
+                if ( !stopFlag && heapAllocCount != heapAllocBefore ) Logging::LogIt(Logging::logFatal) << "Heap allocation inside search " << heapAllocCount - heapAllocBefore;
+#endif
                 if ( stopFlag ) break;
                 delta += 2 + delta/2; // from xiphos ...
                 if (alpha > -MATE && score <= alpha) {
@@ -165,8 +191,9 @@ PVList Searcher::search(const Position & p, Move & m, DepthType & d, ScoreType &
                 bestScore    = score;
                 if ( isMainThread() ){
                     displayGUI(depth,seldepth,bestScore,pv,multi+1);
+                    if (DynamicConfig::ttTelemetry) stats.hashFullSamples.push_back({depth, std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - TimeMan::startTime).count(), TT::hashFull()});
                     if (TimeMan::isDynamic && depth > MoveDifficultyUtil::emergencyMinDepth && bestScore < depthScores[depth - 1] - MoveDifficultyUtil::emergencyMargin) { moveDifficulty = MoveDifficultyUtil::MD_hardDefense; Logging::LogIt(Logging::logInfo) << "Emergency mode activated : " << bestScore << " < " << depthScores[depth - 1] - MoveDifficultyUtil::emergencyMargin; }
-                    if (TimeMan::isDynamic && (TimeType)std::max(1, int(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - TimeMan::startTime).count()*1.8)) > getCurrentMoveMs()) { stopFlag = true; Logging::LogIt(Logging::logInfo) << "stopflag triggered, not enough time for next depth"; break; } // not enought time
+                    if (TimeMan::isDynamic && (TimeType)std::max(1, int(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - TimeMan::budgetStart()).count()*1.8)) > getCurrentMoveMs()) { stopFlag = true; Logging::LogIt(Logging::logInfo) << "stopflag triggered, not enough time for next depth"; break; } // not enought time
                     depthScores[depth] = bestScore;
                 }
                 if ( !pv.empty() ){
@@ -178,7 +205,7 @@ PVList Searcher::search(const Position & p, Move & m, DepthType & d, ScoreType &
         }
     }
 pvsout:
-    if ( isMainThread() ) startLock.store(false);
+    if ( isMainThread() ) releaseStart();
     if (pv.empty()){
         m = INVALIDMOVE;
         Logging::LogIt(Logging::logWarn) << "Empty pv" ;
@@ -186,5 +213,6 @@ pvsout:
     d = reachedDepth;
     sc = bestScore;
     if (isMainThread()) ThreadPool::instance().DisplayStats();
+    if (isMainThread() && DynamicConfig::ttTelemetry) ThreadPool::instance().DisplayTTStats();
     return pv;
 }
@@ -15,10 +15,10 @@
 
 // pvs inspired by Xiphos
 template< bool pvnode, bool canPrune>
-ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, DepthType depth, unsigned int ply, PVList & pv, DepthType & seldepth, bool isInCheck, bool cutNode, const std::vector<MiniMove>* skipMoves){
+ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, DepthType depth, unsigned int ply, PVList & pv, DepthType & seldepth, bool isInCheck, bool cutNode, const SkipList * skipMoves){
+    pv.clear();
     if (stopFlag) return STOPSCORE;
-    //if ( TimeMan::maxKNodes>0 && (stats.counters[Stats::sid_nodes] + stats.counters[Stats::sid_qnodes])/1000 > TimeMan::maxKNodes) { stopFlag = true; Logging::LogIt(Logging::logInfo) << "stopFlag triggered (nodes limits) in thread " << id(); } ///@todo
-    if ( (TimeType)std::max(1, (int)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - TimeMan::startTime).count()) > getCurrentMoveMs() ){ stopFlag = true; Logging::LogIt(Logging::logInfo) << "stopFlag triggered in thread " << id(); }
+    if ( ++nodesSinceTimeCheck >= timeCheckNodes ) timeCheck();
 
     EvalData data;
     if (ply >= MAX_DEPTH - 1 || depth >= MAX_DEPTH - 1) return eval(p, data, *this);
@@ -36,9 +36,17 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
     if (alpha >= beta) return alpha;
 
     const bool rootnode = ply == 0;
+    if (rootnode) rootScores.clear();
 
     if (!rootnode && interiorNodeRecognizer<true, pvnode, true>(p) == MaterialHash::Ter_Draw) return drawScore();
 
+    // a move going back to a position of the history is available, so at least a draw
+    if (!rootnode && alpha < drawScore() && hasUpcomingRep(p,ply)){
+        ++stats.counters[Stats::sid_upcomingRep];
+        alpha = drawScore();
+        if (alpha >= beta) return alpha;
+    }
+
     CMHPtrArray cmhPtr;
     getCMHPtr(p.halfmoves,cmhPtr);
 
@@ -86,11 +94,14 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
                data.gp = gamePhase(p,matScoreW,matScoreB);
                ++stats.counters[Stats::sid_materialTableMiss];
             }
-            ///@todo data.danger is not filled here !!
+            ///@todo data.danger is not filled here !! (the eval cache may have it, but using it changes the search a lot)
         }
         else {
             ++stats.counters[Stats::sid_ttscmiss];
-            evalScore = eval(p, data, *this);
+            if ( !getEvalEntry(pHash, evalScore, data) ){
+               evalScore = eval(p, data, *this);
+               setEvalEntry(pHash, evalScore, data);
+            }
         }
     }
     stack[p.halfmoves].eval = evalScore; // insert only static eval, never hash score !
@@ -100,9 +111,6 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
     if ( (e.h != 0 && !isInCheck) && ((e.b == TT::B_alpha && e.s < evalScore) || (e.b == TT::B_beta && e.s > evalScore) || (e.b == TT::B_exact)) ) evalScore = adjustHashScore(e.s,ply), evalScoreIsHashScore=true;
 
     ScoreType bestScore = -MATE + ply;
-    MoveList moves;
-    bool moveGenerated = false;
-    bool capMoveGenerated = false;
     bool futility = false, lmp = false, /*mateThreat = false,*/ historyPruning = false, CMHPruning = false;
     const bool isNotEndGame = p.mat[p.c][M_t]> 0; ///@todo better ?
     const bool improving = (!isInCheck && ply > 1 && stack[p.halfmoves].eval >= stack[p.halfmoves-2].eval);
@@ -126,7 +134,6 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
 
         // null move
         if (SearchConfig::doNullMove && isNotEndGame && withoutSkipMove /*&& evalScore >= beta*/ && evalScore >= stack[p.halfmoves].eval /*&& stack[p.halfmoves].eval >= beta - 32*depth - 30*improving */ &&  ply >= (unsigned int)nullMoveMinPly && depth >= SearchConfig::nullMoveMinDepth) {
-            PVList nullPV;
             ++stats.counters[Stats::sid_nullMoveTry];
             const DepthType R = depth / 4 + 3 + std::min((evalScore - beta) / 80, 3); // adaptative
             const ScoreType nullIIDScore = evalScore; // pvs<false, false>(beta - 1, beta, p, std::max(depth/4,1), ply, nullPV, seldepth, isInCheck, !cutNode);
@@ -139,8 +146,8 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
                     Position pN = p;
                     applyNull(*this,pN);
                     stack[pN.halfmoves].h = pN.h;
-                    stack[pN.halfmoves].p = pN;
-                    ScoreType nullscore = -pvs<false, false>(-beta, -beta + 1, pN, nullDepth, ply + 1, nullPV, seldepth, isInCheck, !cutNode);
+                    stack[pN.halfmoves].lastMove = NULLMOVE;
+                    ScoreType nullscore = -pvs<false, false>(-beta, -beta + 1, pN, nullDepth, ply + 1, stack[pN.halfmoves].pv, seldepth, isInCheck, !cutNode);
                     if (stopFlag) return STOPSCORE;
                     TT::Entry nullEThreat;
                     TT::getEntry(*this, pN, computeHash(pN), 0, nullEThreat);
@@ -150,7 +157,7 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
                        if (depth <= SearchConfig::nullMoveVerifDepth || nullMoveMinPly>0) return ++stats.counters[Stats::sid_nullMove], isMateScore(nullscore) ? beta : nullscore;
                        ++stats.counters[Stats::sid_nullMoveTry3];
                        nullMoveMinPly = ply + 3*nullDepth/4;
-                       nullscore = pvs<false, false>(beta - 1, beta, p, nullDepth, ply+1, nullPV, seldepth, isInCheck, !cutNode);
+                       nullscore = pvs<false, false>(beta - 1, beta, p, nullDepth, ply+1, pv, seldepth, isInCheck, !cutNode); // non pv search, pv stays empty
                        nullMoveMinPly = 0;
                        if (stopFlag) return STOPSCORE;
                        if (nullscore >= beta ) return ++stats.counters[Stats::sid_nullMove2], nullscore;
@@ -164,18 +171,25 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
           ++stats.counters[Stats::sid_probcutTry];
           int probCutCount = 0;
           const ScoreType betaPC = beta + SearchConfig::probCutMargin;
-          MoveGen::generate<MoveGen::GP_cap>(p,moves);
-          MoveSorter::sort(*this,moves,p,data.gp,ply,cmhPtr,true,isInCheck,e.h?&e:NULL);
-          capMoveGenerated = true;
-          for (auto it = moves.begin() ; it != moves.end() && probCutCount < SearchConfig::probCutMaxMoves /*+ 2*cutNode*/; ++it){
-            if ( (validTTmove && sameMove(e.m, *it)) || isBadCap(*it) ) continue; // skip TT move if quiet or bad captures
+          MovePicker mp(*this,p,data.gp,ply,cmhPtr,MovePicker::PM_probcut,isInCheck,e.h?&e:NULL); // good captures only, without TT move
+          Move m = INVALIDMOVE;
+          while ( probCutCount < SearchConfig::probCutMaxMoves /*+ 2*cutNode*/ && (m = mp.next()) != INVALIDMOVE ){
+            const Piece toPiece = p.b[Move2To(m)];
+#ifdef WITH_MAKE_UNMAKE
+            const ScopedMove move(p,m,mp.legalOnly());
+            if ( ! move.valid ) continue;
+            const Position & p2 = p;
+#else
             Position p2 = p;
-            if ( ! apply(p2,*it) ) continue;
+            if ( ! apply(p2,m,mp.legalOnly()) ) continue;
+#endif
             ++probCutCount;
+            stack[p2.halfmoves].h = p2.h;
+            stack[p2.halfmoves].lastMove = m;
+            stack[p2.halfmoves].lastMoveToPiece = toPiece;
             ScoreType scorePC = -qsearch<true,pvnode>(-betaPC, -betaPC + 1, p2, ply + 1, seldepth);
-            PVList pcPV;
             if (stopFlag) return STOPSCORE;
-            if (scorePC >= betaPC) ++stats.counters[Stats::sid_probcutTry2], scorePC = -pvs<false,true>(-betaPC,-betaPC+1,p2,depth-SearchConfig::probCutMinDepth+1,ply+1,pcPV,seldepth, isAttacked(p2, kingSquare(p2)), !cutNode);
+            if (scorePC >= betaPC) ++stats.counters[Stats::sid_probcutTry2], scorePC = -pvs<false,true>(-betaPC,-betaPC+1,p2,depth-SearchConfig::probCutMinDepth+1,ply+1,stack[p2.halfmoves].pv,seldepth, isAttacked(p2, kingSquare(p2)), !cutNode);
             if (stopFlag) return STOPSCORE;
             if (scorePC >= betaPC) return ++stats.counters[Stats::sid_probcut], scorePC;
           }
@@ -185,8 +199,8 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
     // IID
     if ( (e.h == nullHash /*|| e.d < depth/4*/) && ((pvnode && depth >= SearchConfig::iidMinDepth) || (cutNode && depth >= SearchConfig::iidMinDepth2)) ){ ///@todo try with cutNode only ?
         ++stats.counters[Stats::sid_iid];
-        PVList iidPV;
-        pvs<pvnode,false>(alpha,beta,p,/*pvnode?depth-2:*/depth/2,ply,iidPV,seldepth,isInCheck,cutNode,skipMoves);
+        pvs<pvnode,false>(alpha,beta,p,/*pvnode?depth-2:*/depth/2,ply,pv,seldepth,isInCheck,cutNode,skipMoves);
+        pv.clear(); // iid pv is not used
         if (stopFlag) return STOPSCORE;
         validTTmove = TT::getEntry(*this, p, pHash, depth, e) && e.h != 0 && e.m != INVALIDMINIMOVE;
     }
@@ -209,22 +223,29 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
     bool ttMoveIsCapture = false;
     //bool ttMoveSingularExt = false;
 
+    // quiet moves tried before a cut-off will get a history malus
+    const int maxQuietsTried = 64;
+    Move quietsTried[maxQuietsTried];
+    int nbQuietsTried = 0;
+
     stack[p.halfmoves].threat = refutation;
 
     // try the tt move before move generation (if not skipped move)
     if ( e.h != 0 && validTTmove && !isSkipMove(e.m,skipMoves)) { // should be the case thanks to iid at pvnode
         bestMove = e.m; // in order to preserve tt move for alpha bound entry
+        prefetchChild(p, e.m);
         Position p2 = p;
         if ( apply(p2, e.m)) {
-            TT::prefetch(computeHash(p2));
             const Square to = Move2To(e.m);
             validMoveCount++;
-            PVList childPV;
+            PVList & childPV = stack[p2.halfmoves].pv;
             stack[p2.halfmoves].h = p2.h;
-            stack[p2.halfmoves].p = p2; ///@todo another expensive copy !!!!
+            stack[p2.halfmoves].lastMove = e.m;
+            stack[p2.halfmoves].lastMoveToPiece = p.b[to];
             const bool isCheck = isAttacked(p2, kingSquare(p2));
             if ( isCapture(e.m) ) ttMoveIsCapture = true;
             const bool isQuiet = Move2Type(e.m) == T_std;
+            if ( isQuiet ) quietsTried[nbQuietsTried++] = e.m;
             const bool isAdvancedPawnPush = PieceTools::getPieceType(p,Move2From(e.m)) == P_wp && (SQRANK(to) > 5 || SQRANK(to) < 2);
             // extensions
             DepthType extension = 0;
@@ -249,10 +270,10 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
                if (!extension && pvnode && (p.pieces<P_wq>(p.c) && isQuiet && PieceTools::getPieceType(p, Move2From(e.m)) == P_wq && isAttacked(p, BBTools::SquareFromBitBoard(p.pieces<P_wq>(p.c)))) && SEE_GE(p, e.m, 0)) ++stats.counters[Stats::sid_queenThreatExtension], ++extension;
                if (!extension && withoutSkipMove && depth >= SearchConfig::singularExtensionDepth && !rootnode && !isMateScore(e.s) && e.b == TT::B_beta && e.d >= depth - 3){
                    const ScoreType betaC = e.s - 2*depth;
-                   PVList sePV;
                    DepthType seSeldetph = 0;
-                   std::vector<MiniMove> skip({Move2MiniMove(e.m)});
-                   const ScoreType score = pvs<false,false>(betaC - 1, betaC, p, depth/2, ply, sePV, seSeldetph, isInCheck, cutNode, &skip);
+                   SkipList skip;
+                   skip.push_back(Move2MiniMove(e.m));
+                   const ScoreType score = pvs<false,false>(betaC - 1, betaC, p, depth/2, ply, pv, seSeldetph, isInCheck, cutNode, &skip); // non pv search, pv stays empty
                    if (stopFlag) return STOPSCORE;
                    if (score < betaC) {
                        ++stats.counters[Stats::sid_singularExtension],++extension;
@@ -289,79 +310,106 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
         }
     }
 
+    MoveList rootMoves; // only filled at root by TB, generation is done by the move picker otherwise
 #ifdef WITH_SYZYGY
     if (rootnode && withoutSkipMove && (countBit(p.allPieces[Co_White] | p.allPieces[Co_Black])) <= SyzygyTb::MAX_TB_MEN) {
         ScoreType tbScore = 0;
-        if (SyzygyTb::probe_root(*this, p, tbScore, moves) < 0) { // only good moves if TB success
-            if (capMoveGenerated) MoveGen::generate<MoveGen::GP_quiet>(p, moves, true);
-            else                  MoveGen::generate<MoveGen::GP_all>  (p, moves, false);
-        }
+        if (SyzygyTb::probe_root(*this, p, tbScore, rootMoves) < 0) rootMoves.clear(); // only good moves if TB success
         else ++stats.counters[Stats::sid_tbHit2];
-        moveGenerated = true;
     }
 #endif
 
     ScoreType score = -MATE + ply;
 
-    if (!moveGenerated) {
-        if (capMoveGenerated) MoveGen::generate<MoveGen::GP_quiet>(p, moves, true);
-        else                  MoveGen::generate<MoveGen::GP_all>  (p, moves, false);
-    }
-    if (moves.empty()) return isInCheck ? -MATE + ply : 0;
-    MoveSorter::sort(*this, moves, p, data.gp, ply, cmhPtr, true, isInCheck, e.h?&e:NULL, refutation != INVALIDMOVE && isCapture(Move2Type(refutation)) ? refutation : INVALIDMOVE);
-
-    for(auto it = moves.begin() ; it != moves.end() && !stopFlag ; ++it){
-        if (isSkipMove(*it,skipMoves)) continue; // skipmoves
-        if (validTTmove && sameMove(e.m, *it)) continue; // already tried
+    MovePicker mp(*this, p, data.gp, ply, cmhPtr, (rootnode || isInCheck) ? MovePicker::PM_all : MovePicker::PM_main, isInCheck, e.h?&e:NULL, refutation != INVALIDMOVE && isCapture(Move2Type(refutation)) ? refutation : INVALIDMOVE, rootMoves.empty() ? NULL : &rootMoves);
+
+    // ABDADA : moves currently searched by another thread are deferred after all the others
+    const bool abdada = DynamicConfig::smpMode == DynamicConfig::smp_abdada && !rootnode && depth >= SearchConfig::abdadaMinDepth && ThreadPool::instance().size() > 1;
+    DeferredList deferred; // small, so that the default SMP mode does not pay a full move list on each frame
+    size_t deferredIdx = 0;
+
+    Move m = INVALIDMOVE;
+    while( !stopFlag && ((m = mp.next()) != INVALIDMOVE || (deferredIdx < deferred.size() && (m = deferred[deferredIdx++]) != INVALIDMOVE)) ){
+        if (isSkipMove(m,skipMoves)) continue; // skipmoves
+        if (validTTmove && sameMove(e.m, m)) continue; // already tried
+        Hash abdadaHash = nullHash;
+        if ( abdada && deferredIdx == 0 && validMoveCount > 0 ){ // never the first move, and not twice
+            abdadaHash = ABDADA::moveHash(p.h, m, depth);
+            if ( deferred.size() < MAX_DEFERRED && ABDADA::isSearched(abdadaHash) ){ ++stats.counters[Stats::sid_abdadaDefer]; deferred.push_back(m); continue; }
+        }
+        const bool isQuiet = Move2Type(m) == T_std;
+        if ( isQuiet && nbQuietsTried < maxQuietsTried ) quietsTried[nbQuietsTried++] = m;
+        prefetchChild(p, m);
+        const Move nextMove = mp.peek(); // will probably be needed after this child search
+        if ( VALIDMOVE(nextMove) ) TT::prefetch(keyAfter(p, nextMove));
+        // everything needed from the parent position is gathered before the move is made (p is modified in place with WITH_MAKE_UNMAKE)
+        const Color side = p.c;
+        const Square to = Move2To(m);
+        if (side == Co_White && to == p.king(Co_Black)) return MATE - ply + 1;
+        if (side == Co_Black && to == p.king(Co_White)) return MATE - ply + 1;
+        const Piece toPiece = p.b[to];
+        const int pp = (p.b[Move2From(m)] + PieceShift) * 64 + to;
+        bool isAdvancedPawnPush = PieceTools::getPieceType(p,Move2From(m)) == P_wp && (SQRANK(to) > 5 || SQRANK(to) < 2);
+        const bool isBMThreat = ply > 1 && stack[p.halfmoves].threat != INVALIDMOVE && stack[p.halfmoves - 2].threat != INVALIDMOVE && (sameMove(stack[p.halfmoves].threat, stack[p.halfmoves - 2].threat) || (Move2To(stack[p.halfmoves].threat) == Move2To(stack[p.halfmoves - 2].threat) && isCapture(stack[p.halfmoves].threat)));
+        const bool isQueenThreat = DynamicConfig::level>80 && pvnode && validMoveCount == 0 && (p.pieces<P_wq>(side) && isQuiet && PieceTools::getPieceType(p, Move2From(m)) == P_wq && isAttacked(p, BBTools::SquareFromBitBoard(p.pieces<P_wq>(side)))) && SEE_GE(p, m, 0);
+        // quiet SEE pruning comes last, after futility, LMP, history and CMH pruning that do not need SEE
+        const bool quietPruned = futility || (lmp && validMoveCount >= SearchConfig::lmpLimit[improving][depth])
+                              || (historyPruning && Move2Score(m) < SearchConfig::historyPruningThresholdInit + depth*SearchConfig::historyPruningThresholdDepth)
+                              || (CMHPruning && (!cmhPtr[0] || cmhPtr[0][pp] < 0) && (!cmhPtr[1] || cmhPtr[1][pp] < 0));
+        const bool seeQuietNeeded = SearchConfig::doPVS && validMoveCount > 0 && isQuiet && !quietPruned && !isInCheck && !isMateScore(alpha) && !DynamicConfig::mateFinder && !killerT.isKiller(m,ply);
+        const ScoreType seeQuiet = seeQuietNeeded ? SEE(p,m) : 0;
+#ifdef WITH_MAKE_UNMAKE
+        const ScopedMove move(p,m,mp.legalOnly());
+        if ( ! move.valid ) continue;
+        const Position & p2 = p;
+#else
         Position p2 = p;
-        if ( ! apply(p2,*it) ) continue;
-        TT::prefetch(computeHash(p2));
-        const Square to = Move2To(*it);
-        if (p.c == Co_White && to == p.king[Co_Black]) return MATE - ply + 1;
-        if (p.c == Co_Black && to == p.king[Co_White]) return MATE - ply + 1;
+        if ( ! apply(p2,m,mp.legalOnly()) ) continue;
+#endif
         validMoveCount++;
         const bool firstMove = validMoveCount == 1;
-        PVList childPV;
+        PVList & childPV = stack[p2.halfmoves].pv;
         stack[p2.halfmoves].h = p2.h;
-        stack[p2.halfmoves].p = p2; ///@todo another expensive copy !!!!
+        stack[p2.halfmoves].lastMove = m;
+        stack[p2.halfmoves].lastMoveToPiece = toPiece;
         const bool isCheck = isAttacked(p2, kingSquare(p2));
-        bool isAdvancedPawnPush = PieceTools::getPieceType(p,Move2From(*it)) == P_wp && (SQRANK(to) > 5 || SQRANK(to) < 2);
         // extensions
         DepthType extension = 0;
-        const bool isQuiet = Move2Type(*it) == T_std;
         if ( DynamicConfig::level>80){
            if (!extension && pvnode && isInCheck) ++stats.counters[Stats::sid_checkExtension],++extension; // we are in check (extension)
-           if (!extension && isCastling(*it) ) ++stats.counters[Stats::sid_castlingExtension],++extension;
-           if (!extension && ply > 1 && stack[p.halfmoves].threat != INVALIDMOVE && stack[p.halfmoves - 2].threat != INVALIDMOVE && (sameMove(stack[p.halfmoves].threat, stack[p.halfmoves - 2].threat) || (Move2To(stack[p.halfmoves].threat) == Move2To(stack[p.halfmoves - 2].threat) && isCapture(stack[p.halfmoves].threat)))) ++stats.counters[Stats::sid_BMExtension], ++extension;
+           if (!extension && isCastling(m) ) ++stats.counters[Stats::sid_castlingExtension],++extension;
+           if (!extension && isBMThreat) ++stats.counters[Stats::sid_BMExtension], ++extension;
            //if (!extension && mateThreat && depth <= 4) ++stats.counters[Stats::sid_mateThreatExtension],++extension;
-           //if (!extension && VALIDMOVE(p.lastMove) && !isBadCap(*it) && Move2Type(p.lastMove) == T_capture && Move2To(*it) == Move2To(p.lastMove)) ++stats.counters[Stats::sid_recaptureExtension],++extension; //recapture
-           //if (!extension && isCheck && !isBadCap(*it)) ++stats.counters[Stats::sid_checkExtension2],++extension; // we give check with a non risky move
+           //if (!extension && VALIDMOVE(p.lastMove) && !isBadCap(m) && Move2Type(p.lastMove) == T_capture && Move2To(m) == Move2To(p.lastMove)) ++stats.counters[Stats::sid_recaptureExtension],++extension; //recapture
+           //if (!extension && isCheck && !isBadCap(m)) ++stats.counters[Stats::sid_checkExtension2],++extension; // we give check with a non risky move
            if (!extension && !firstMove && isQuiet) {
-               const int pp = (p.b[Move2From(*it)] + PieceShift) * 64 + Move2To(*it);
                if (cmhPtr[0] && cmhPtr[1] && cmhPtr[0][pp] >= MAX_HISTORY / 2 && cmhPtr[1][pp] >= MAX_HISTORY / 2) ++stats.counters[Stats::sid_CMHExtension], ++extension;
            }
-           if (!extension && isAdvancedPawnPush /*&& (killerT.isKiller(*it, ply) || !isBadCap(*it))*/) {
+           if (!extension && isAdvancedPawnPush /*&& (killerT.isKiller(m, ply) || !isBadCap(m))*/) {
                const BitBoard pawns[2] = { p2.pieces<P_wp>(Co_White), p2.pieces<P_wp>(Co_Black) };
                const BitBoard passed[2] = { BBTools::pawnPassed<Co_White>(pawns[Co_White], pawns[Co_Black]), BBTools::pawnPassed<Co_Black>(pawns[Co_Black], pawns[Co_White]) };
-               isAdvancedPawnPush = SquareToBitboard(to) & passed[p.c];
+               isAdvancedPawnPush = SquareToBitboard(to) & passed[side];
                if (isAdvancedPawnPush) ++stats.counters[Stats::sid_pawnPushExtension], ++extension;
            }
-           if (!extension && pvnode && firstMove && (p.pieces<P_wq>(p.c) && isQuiet && Move2Type(*it) == T_std && PieceTools::getPieceType(p, Move2From(*it)) == P_wq && isAttacked(p, BBTools::SquareFromBitBoard(p.pieces<P_wq>(p.c)))) && SEE_GE(p, *it, 0)) ++stats.counters[Stats::sid_queenThreatExtension], ++extension;
+           if (!extension && isQueenThreat) ++stats.counters[Stats::sid_queenThreatExtension], ++extension;
         }
         // pvs
-        if (validMoveCount < (2/*+2*rootnode*/) || !SearchConfig::doPVS ) score = -pvs<pvnode,true>(-beta,-alpha,p2,depth-1+extension,ply+1,childPV,seldepth,isCheck,!cutNode);
+        if (validMoveCount < (2/*+2*rootnode*/) || !SearchConfig::doPVS ){
+            if ( abdadaHash != nullHash ) ABDADA::startSearch(abdadaHash);
+            score = -pvs<pvnode,true>(-beta,-alpha,p2,depth-1+extension,ply+1,childPV,seldepth,isCheck,!cutNode);
+        }
         else{
             // reductions & prunings
             DepthType reduction = 0;
-            const bool isPrunable           = /*isNotEndGame &&*/ !isAdvancedPawnPush && !isMateScore(alpha) && !DynamicConfig::mateFinder && !killerT.isKiller(*it,ply);
+            const bool isPrunable           = /*isNotEndGame &&*/ !isAdvancedPawnPush && !isMateScore(alpha) && !DynamicConfig::mateFinder && !killerT.isKiller(m,ply);
             const bool isReductible         = /*isNotEndGame &&*/ !isAdvancedPawnPush && !DynamicConfig::mateFinder;
             const bool noCheck              = !isInCheck && !isCheck;
             const bool isPrunableStd        = isPrunable && isQuiet;
             const bool isPrunableStdNoCheck = isPrunableStd && noCheck;
-            const bool isPrunableCap        = isPrunable && Move2Type(*it) == T_capture && isBadCap(*it) && noCheck ;
-            const bool isDangerPrune        = data.danger[p.c] > SearchConfig::dangerLimitPruning[0] || data.danger[~p.c] > SearchConfig::dangerLimitPruning[1];
-            const bool isDangerRed          = data.danger[p.c] > SearchConfig::dangerLimitReduction[0] || data.danger[~p.c] > SearchConfig::dangerLimitReduction[1];
-            const float dangerPruneFactor   = ((1.f+data.danger[p.c])/SearchConfig::dangerLimitPruning[0] + (1.f+data.danger[~p.c])/SearchConfig::dangerLimitPruning[1])/2;
+            const bool isPrunableCap        = isPrunable && Move2Type(m) == T_capture && isBadCap(m) && noCheck ;
+            const bool isDangerPrune        = data.danger[side] > SearchConfig::dangerLimitPruning[0] || data.danger[~side] > SearchConfig::dangerLimitPruning[1];
+            const bool isDangerRed          = data.danger[side] > SearchConfig::dangerLimitReduction[0] || data.danger[~side] > SearchConfig::dangerLimitReduction[1];
+            const float dangerPruneFactor   = ((1.f+data.danger[side])/SearchConfig::dangerLimitPruning[0] + (1.f+data.danger[~side])/SearchConfig::dangerLimitPruning[1])/2;
             if ( isDangerPrune) ++stats.counters[Stats::sid_dangerPrune];
             if ( isDangerRed)   ++stats.counters[Stats::sid_dangerReduce];
             // futility
@@ -369,16 +417,15 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
             // LMP
             if (lmp && isPrunableStdNoCheck && validMoveCount > (1/*+dangerPruneFactor*/)*SearchConfig::lmpLimit[improving][depth] ) {++stats.counters[Stats::sid_lmp]; continue;}
             // History pruning (with CMH)
-            if (historyPruning && isPrunableStdNoCheck && Move2Score(*it) < SearchConfig::historyPruningThresholdInit + depth*SearchConfig::historyPruningThresholdDepth) {++stats.counters[Stats::sid_historyPruning]; continue;}
+            if (historyPruning && isPrunableStdNoCheck && Move2Score(m) < SearchConfig::historyPruningThresholdInit + depth*SearchConfig::historyPruningThresholdDepth) {++stats.counters[Stats::sid_historyPruning]; continue;}
             // CMH pruning alone
             if (CMHPruning && isPrunableStdNoCheck){
-              const int pp = (p.b[Move2From(*it)]+PieceShift) * 64 + Move2To(*it);
               if ((!cmhPtr[0] || cmhPtr[0][pp] < 0) && (!cmhPtr[1] || cmhPtr[1][pp] < 0)) { ++stats.counters[Stats::sid_CMHPruning]; continue;}
             }
             // SEE (capture)
             if (isPrunableCap){
                if (futility) {++stats.counters[Stats::sid_see]; continue;}
-               else if ( !rootnode && badCapScore(*it) < -(1+dangerPruneFactor*dangerPruneFactor)*100*depth /*!SEE_GE(p,*it,-100*depth)*/) {++stats.counters[Stats::sid_see2]; continue;}
+               else if ( !rootnode && badCapScore(m) < -(1+dangerPruneFactor*dangerPruneFactor)*100*depth /*!SEE_GE(p,m,-100*depth)*/) {++stats.counters[Stats::sid_see2]; continue;}
             }
             // LMR
             if (SearchConfig::doLMR && (isReductible && isQuiet ) && depth >= SearchConfig::lmrMinDepth ){
@@ -387,7 +434,7 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
                 reduction += !improving;
                 reduction += ttMoveIsCapture/*&&isPrunableStd*/;
                 //reduction += cutNode&&isPrunableStd;
-                reduction -= (2 * Move2Score(*it)) / MAX_HISTORY; //history reduction/extension (beware killers and counter are socred above history max, so reduced less
+                reduction -= (2 * Move2Score(m)) / MAX_HISTORY; //history reduction/extension (beware killers and counter are socred above history max, so reduced less
                 if ( reduction > 0){
                     if      ( pvnode           ) --reduction;
                     else if ( isDangerRed      ) --reduction;
@@ -399,11 +446,12 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
             }
             const DepthType nextDepth = depth-1-reduction+extension;
             // SEE (quiet)
-            if ( isPrunableStdNoCheck && /*!rootnode &&*/ !SEE_GE(p,*it,-15*(1/*+isDangerPrune*/)*nextDepth*nextDepth)) {
+            if ( isPrunableStdNoCheck && /*!rootnode &&*/ seeQuiet < -15*(1/*+isDangerPrune*/)*nextDepth*nextDepth) { // SEE was computed before the move was made
                 ++stats.counters[Stats::sid_seeQuiet]; 
                 continue;
             }
             // PVS
+            if ( abdadaHash != nullHash ) ABDADA::startSearch(abdadaHash); // only now, pruned moves are not searched
             score = -pvs<false,true>(-alpha-1,-alpha,p2,nextDepth,ply+1,childPV,seldepth,isCheck,true);
             if ( reduction > 0 && score > alpha ){ 
                 ++stats.counters[Stats::sid_lmrFail]; childPV.clear(); 
@@ -414,27 +462,22 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
                 score = -pvs<true ,true>(-beta   ,-alpha,p2,depth-1+extension,ply+1,childPV,seldepth,isCheck,false); 
             } // potential new pv node
         }
+        if ( abdadaHash != nullHash ) ABDADA::finishSearch(abdadaHash);
         if (stopFlag) return STOPSCORE;
-        if (rootnode) rootScores.push_back({*it,score});
-        if (rootnode) previousBest = *it;
+        if (rootnode) rootScores.push_back({m,score});
+        if (rootnode) previousBest = m;
         if ( score > bestScore ){
             bestScore = score;
-            bestMove = *it;
+            bestMove = m;
             //bestScoreUpdated = true;
             if ( score > alpha ){
-                if (pvnode) updatePV(pv, *it, childPV);
+                if (pvnode) updatePV(pv, m, childPV);
                 //alphaUpdated = true;
                 alpha = score;
                 hashBound = TT::B_exact;
                 if ( score >= beta ){
-                    if ( !isInCheck && isQuiet ){
-                        updateTables(*this, p, depth + (score>beta+80), ply, *it, TT::B_beta, cmhPtr);
-                        for(auto it2 = moves.begin() ; it2 != moves.end() && !sameMove(*it2,*it); ++it2) {
-                            if ( Move2Type(*it2) == T_std ) historyT.update<-1>(depth + (score > (beta + 80)), *it2, p, cmhPtr);
-                        }
-                    }
                     hashBound = TT::B_beta;
-                    break;
+                    break; // tables are updated once the move is undone
                 }
             }
         }
@@ -443,6 +486,10 @@ ScoreType Searcher::pvs(ScoreType alpha, ScoreType beta, const Position & p, Dep
         }
     }
 
+    if ( hashBound == TT::B_beta && !isInCheck && Move2Type(bestMove) == T_std ){
+        updateTables(*this, p, depth + (bestScore>beta+80), ply, bestMove, TT::B_beta, cmhPtr);
+        for(int k = 0 ; k < nbQuietsTried && !sameMove(quietsTried[k],bestMove); ++k) historyT.update<-1>(depth + (bestScore > (beta + 80)), quietsTried[k], p, cmhPtr);
+    }
     if ( validMoveCount==0 ) return (isInCheck || !withoutSkipMove)?-MATE + ply : 0;
     TT::setEntry(*this,pHash,bestMove,createHashScore(bestScore,ply),createHashScore(evalScore,ply),hashBound,depth);
     return bestScore;
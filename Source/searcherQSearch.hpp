@@ -7,7 +7,8 @@ inline ScoreType qDeltaMargin(const Position & p) {
 
 template < bool qRoot, bool pvnode >
 ScoreType Searcher::qsearch(ScoreType alpha, ScoreType beta, const Position & p, unsigned int ply, DepthType & seldepth){
-    if (stopFlag) return STOPSCORE; // no time verification in qsearch, too slow
+    if (stopFlag) return STOPSCORE; // no time verification in qsearch, but nodes are counted for the next one in pvs
+    ++nodesSinceTimeCheck;
     ++stats.counters[Stats::sid_qnodes];
 
     alpha = std::max(alpha, (ScoreType)(-MATE + ply));
@@ -61,7 +62,10 @@ ScoreType Searcher::qsearch(ScoreType alpha, ScoreType beta, const Position & p,
         }
         else {
             ++stats.counters[Stats::sid_ttscmiss];
-            evalScore = eval(p, data, *this);
+            if ( !getEvalEntry(pHash, evalScore, data) ){
+               evalScore = eval(p, data, *this);
+               setEvalEntry(pHash, evalScore, data);
+            }
         }
     }
     bool evalScoreIsHashScore = false;
@@ -75,24 +79,30 @@ ScoreType Searcher::qsearch(ScoreType alpha, ScoreType beta, const Position & p,
     if ( /*pvnode &&*/ evalScore > alpha) alpha = evalScore; ///@todo ??
     ScoreType bestScore = evalScore;
 
-    MoveList moves;
-    if ( isInCheck ) MoveGen::generate<MoveGen::GP_all>(p,moves); ///@odo generate only evasion !
-    else             MoveGen::generate<MoveGen::GP_cap>(p,moves);
-    MoveSorter::sort(*this,moves,p,data.gp,ply,cmhPtr,isInCheck,isInCheck,e.h?&e:NULL); ///@todo warning gp = 0 here !
+    MovePicker mp(*this,p,data.gp,ply,cmhPtr,isInCheck ? MovePicker::PM_all : MovePicker::PM_qsearch,isInCheck,e.h?&e:NULL); ///@todo warning gp = 0 here !
 
     const ScoreType alphaInit = alpha;
 
-    for(auto it = moves.begin() ; it != moves.end() ; ++it){
+    Move m = INVALIDMOVE;
+    while( (m = mp.next()) != INVALIDMOVE ){
         if (!isInCheck) {
-            if (!SEE_GE(p,*it,0)) {++stats.counters[Stats::sid_qsee];continue;}
-            if (SearchConfig::doQFutility && evalScore + SearchConfig::qfutilityMargin[evalScoreIsHashScore] + (Move2Type(*it)==T_ep ? Values[P_wp+PieceShift] : PieceTools::getAbsValue(p, Move2To(*it))) <= alphaInit) {++stats.counters[Stats::sid_qfutility];continue;}
+            if (!SEE_GE(p,m,0)) {++stats.counters[Stats::sid_qsee];continue;}
+            if (SearchConfig::doQFutility && evalScore + SearchConfig::qfutilityMargin[evalScoreIsHashScore] + (Move2Type(m)==T_ep ? Values[P_wp+PieceShift] : PieceTools::getAbsValue(p, Move2To(m))) <= alphaInit) {++stats.counters[Stats::sid_qfutility];continue;}
         }
+        prefetchChild(p, m);
+        const Move nextMove = mp.peek();
+        if ( VALIDMOVE(nextMove) ) TT::prefetch(keyAfter(p, nextMove));
+#ifdef WITH_MAKE_UNMAKE
+        const ScopedMove move(p,m,mp.legalOnly());
+        if ( ! move.valid ) continue;
+        const Position & p2 = p;
+#else
         Position p2 = p;
-        if ( ! apply(p2,*it) ) continue;
-        TT::prefetch(computeHash(p2));
+        if ( ! apply(p2,m,mp.legalOnly()) ) continue;
+#endif
         const ScoreType score = -qsearch<false,false>(-beta,-alpha,p2,ply+1,seldepth);
         if ( score > bestScore){
-           bestMove = *it;
+           bestMove = m;
            bestScore = score;
            if ( score > alpha ){
                if (score >= beta) {
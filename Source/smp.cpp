@@ -1,5 +1,6 @@
 #include "smp.hpp"
 
+#include "affinity.hpp"
 #include "dynamicConfig.hpp"
 #include "logging.hpp"
 #include "searcher.hpp"
@@ -11,6 +12,7 @@ ThreadPool::~ThreadPool(){ Logging::LogIt(Logging::logInfo) << "... ok threadPoo
 void ThreadPool::setup(){
     assert(DynamicConfig::threads > 0);
     clear();
+    _bestThread = 0;
     Logging::LogIt(Logging::logInfo) << "Using " << DynamicConfig::threads << " threads";
     unsigned int maxThreads = std::max(1u,std::thread::hardware_concurrency());
     if (DynamicConfig::threads > maxThreads) {
@@ -19,8 +21,13 @@ void ThreadPool::setup(){
     }
     while (size() < DynamicConfig::threads) {
        push_back(std::unique_ptr<Searcher>(new Searcher(size())));
-       back()->initPawnTable();
     }
+    // pin threads before they touch their own tables, so that first-touch places them on the right NUMA node
+    if ( DynamicConfig::threadAffinity ) parallelRun([](size_t id, size_t){ Affinity::bindThisThread(id); });
+    initPawnTables();
+    parallelRun([this](size_t id, size_t){ (*this)[id]->initEvalTable(); (*this)[id]->clearGame(); });
+    // the TT is not cleared here : changing threads in a game shall not lose it (nor a shared or loaded table),
+    // it is cleared (and first touched by the threads) by TT::initTable after an allocation and on a new game
 }
 
 Searcher & ThreadPool::main() { return *(front()); }
@@ -34,17 +41,101 @@ void ThreadPool::wait(bool otherOnly) {
 Move ThreadPool::search(const ThreadData & d){ // distribute data and call main thread search
     Logging::LogIt(Logging::logInfo) << "Search Sync" ;
     wait();
-    Searcher::startLock.store(true);
+    Searcher::lockStart();
     for (auto & s : *this) (*s).setData(d); // this is a copy
     Logging::LogIt(Logging::logInfo) << "Calling main thread search" ;
     main().search(); ///@todo 1 thread for nothing here
     Searcher::stopFlag = true;
     wait();
-    return main().getData().best;
+    _bestThread = electBestThread();
+    if ( _bestThread != 0 ){
+        const ThreadData & r = result();
+        Logging::LogIt(Logging::logInfo) << "Thread " << _bestThread << " elected (depth " << (int)r.depth << ", score " << r.sc << ") instead of main thread (depth " << (int)main().getData().depth << ", score " << main().getData().sc << ")";
+        Searcher::displayGUI(r.depth,r.seldepth,r.sc,r.pv,1);
+    }
+    return result().best;
 }
 
+const ThreadData & ThreadPool::result()const{ return (*this)[_bestThread]->getData(); }
+
+size_t ThreadPool::electBestThread()const{
+    const ThreadData & m = front()->getData();
+    // no vote for a book move, a random mover, a weakened level or multiPV
+    if ( size() == 1 || m.depth <= 0 || m.pv.empty() || DynamicConfig::multiPV != 1 || DynamicConfig::level != SearchConfig::nlevel ) return 0;
+    ScoreType minScore = m.sc;
+    for (auto & s : *this){ const ThreadData & t = s->getData(); if ( t.depth > 0 && !t.pv.empty() ) minScore = std::min(minScore, t.sc); }
+    std::map<MiniMove,long long int> votes; // moves are compared without their sorting score
+    for (auto & s : *this){ const ThreadData & t = s->getData(); if ( t.depth > 0 && !t.pv.empty() ) votes[Move2MiniMove(t.best)] += (long long int)(t.sc - minScore + 14) * t.depth; }
+    size_t best = 0;
+    for (size_t k = 1 ; k < size() ; ++k){
+        const ThreadData & t = (*this)[k]->getData();
+        const ThreadData & b = (*this)[best]->getData();
+        if ( t.depth <= 0 || t.pv.empty() ) continue;
+        const long long int vt = votes[Move2MiniMove(t.best)];
+        const long long int vb = votes[Move2MiniMove(b.best)];
+        if ( isMateScore(b.sc) ){ if ( t.sc > b.sc ) best = k; } // shortest mate (or longest being mated)
+        else if ( isMatingScore(t.sc) || ( !isMatedScore(t.sc) && ( vt > vb || (vt == vb && t.depth > b.depth) ) ) ) best = k;
+    }
+    return best;
+}
+
+void ThreadPool::parallelRun(const std::function<void(size_t,size_t)> & task){
+    wait();
+    const size_t n = size();
+    for (auto & s : *this){ const size_t id = (*s).id(); (*s).runTask([&task,id,n]{ task(id,n); }); }
+    wait();
+}
+
+void ThreadPool::initPawnTables(){
+    wait();
+    Searcher::initPawnTableShared(DynamicConfig::sharedPawnTable ? size() : 0);
+    // done by each thread, so that its pages are touched first by it
+    parallelRun([this](size_t id, size_t n){ (*this)[id]->initPawnTable(); Searcher::clearPawnTableShared(id,n); });
+}
+
+void ThreadPool::clearGame(){ parallelRun([this](size_t id, size_t){ (*this)[id]->clearGame(); }); }
+
 void ThreadPool::startOthers(){ for (auto & s : *this) if (!(*s).isMainThread()) (*s).start();}
 
-ThreadPool::ThreadPool():stop(false){ push_back(std::unique_ptr<Searcher>(new Searcher(size())));} // this one will be called "Main" thread
+ThreadPool::ThreadPool():stop(false),_bestThread(0){ push_back(std::unique_ptr<Searcher>(new Searcher(size())));} // this one will be called "Main" thread
+
+void ThreadPool::DisplayTTStats()const{
+    std::stringstream str;
+    str << "TT telemetry" << std::endl << std::setw(6) << "draft";
+    for (size_t k = 0 ; k < Stats::tid_maxid ; ++k) str << std::setw(14) << Stats::TTNames[k];
+    str << std::setw(8) << "hit%";
+    for (int draft = 0 ; draft < Stats::ttDrafts ; ++draft){
+        std::array<Counter,Stats::tid_maxid> c;
+        c.fill(0ull);
+        for (auto & it : *this ) for (size_t k = 0 ; k < Stats::tid_maxid ; ++k) c[k] += it->stats.ttCounters[draft][k];
+        const Counter probes = c[Stats::tid_hit] + c[Stats::tid_shallow] + c[Stats::tid_miss] + c[Stats::tid_keyFail] + c[Stats::tid_noMove] + c[Stats::tid_pseudoLegal];
+        if ( probes == 0 && c[Stats::tid_store] == 0 ) continue;
+        str << std::endl << std::setw(5) << draft-2 << (draft == Stats::ttDrafts-1 ? "+" : " ");
+        for (size_t k = 0 ; k < Stats::tid_maxid ; ++k) str << std::setw(14) << c[k];
+        str << std::setw(8) << std::fixed << std::setprecision(1) << (probes ? 100.f*c[Stats::tid_hit]/probes : 0.f);
+    }
+    for (const auto & s : front()->stats.hashFullSamples) str << std::endl << "hashfull depth " << int(s.depth) << " time " << s.ms << " : " << s.hashFull;
+    Logging::LogIt(Logging::logInfo) << str.str();
+}
 
 Counter ThreadPool::counter(Stats::StatId id) const { Counter n = 0; for (auto & it : *this ){ n += it->stats.counters[id];  } return n;}
+
+namespace ABDADA{
+
+namespace{
+const size_t tableSize = 32768; // power of 2
+std::atomic<Hash> table[tableSize];
+}
+
+Hash moveHash(Hash h, Move m, DepthType depth){ return h ^ ((Hash(Move2MiniMove(m)) << 8 | (unsigned char)depth) * 0x9E3779B97F4A7C15ull); }
+
+bool isSearched(Hash mh){ return table[mh & (tableSize-1)].load(std::memory_order_relaxed) == mh; }
+
+void startSearch(Hash mh){ table[mh & (tableSize-1)].store(mh, std::memory_order_relaxed); }
+
+void finishSearch(Hash mh){
+    Hash expected = mh;
+    table[mh & (tableSize-1)].compare_exchange_strong(expected, nullHash, std::memory_order_relaxed); // only if not overwritten by another move
+}
+
+} // ABDADA
@@ -13,6 +13,7 @@ struct ThreadData{
     Position p;
     Move best;
     PVList pv;
+    std::vector<Hash> history; // game positions before p (last one is the parent of p), may be empty
 };
 
 /* This is the singleton pool of threads
@@ -24,15 +25,40 @@ public:
     static ThreadPool & instance();
     ~ThreadPool();
     void setup();
+    // (re)allocate pawn tables, either one per thread or a shared one
+    void initPawnTables();
+    // new game, history tables of all threads are reset
+    void clearGame();
     Searcher & main();
     Move search(const ThreadData & d);
+    // result of the last search, from the thread elected by the end of search vote
+    const ThreadData & result()const;
     void startOthers();
     void wait(bool otherOnly = false);
+    // run task(id,n) on every thread of the pool and wait for all of them to finish
+    void parallelRun(const std::function<void(size_t,size_t)> & task);
     bool stop;
     // gathering counter information from all threads
     Counter counter(Stats::StatId id) const;
     void DisplayStats()const{for(size_t k = 0 ; k < Stats::sid_maxid ; ++k) Logging::LogIt(Logging::logInfo) << Stats::Names[k] << " " << counter((Stats::StatId)k);}
+    // TT telemetry table gathered from all threads, and hashfull samples of the main thread
+    void DisplayTTStats()const;
 private:
     ThreadPool();
+    // Stockfish like vote between threads, weighted by completed depth and score
+    size_t electBestThread()const;
+    size_t _bestThread;
 };
 
+
+/* ABDADA like coordination between threads (simplified version from Tom Kerrigan)
+ * A small shared table holds the (position, move, depth) currently searched by some thread,
+ * other threads then defer those moves to the end of their move loop.
+ * Collisions only lead to a wrong deferral, never to a wrong score.
+ */
+namespace ABDADA{
+    Hash moveHash(Hash h, Move m, DepthType depth);
+    bool isSearched(Hash mh);
+    void startSearch(Hash mh);
+    void finishSearch(Hash mh);
+}
@@ -23,7 +23,16 @@ void HistoryT::initHistory(){
     Logging::LogIt(Logging::logInfo) << "Init history" ;
     for(int i = 0; i < 64; ++i) for(int k = 0 ; k < 64; ++k) history[0][i][k] = history[1][i][k] = 0;
     for(int i = 0; i < 13; ++i) for(int k = 0 ; k < 64; ++k) historyP[i][k] = 0;
-    for(int i = 0; i < 13; ++i) for(int j = 0 ; j < 64; ++j) for(int k = 0 ; k < 64; ++k)  counter_history[i][j][k] = -1;
+    for(int i = 0; i < 13; ++i) for(int j = 0 ; j < 64; ++j) for(int k = 0 ; k < 64*13; ++k) counter_history[i][j][k] = -1;
+    for(int i = 0; i < 13; ++i) for(int j = 0 ; j < 64; ++j) counter_historyGen[i][j] = 0;
+    generation = 0;
+}
+
+void HistoryT::ageHistory(){
+    Logging::LogIt(Logging::logInfo) << "Age history" ;
+    for(int i = 0; i < 64; ++i) for(int k = 0 ; k < 64; ++k){ history[0][i][k] /= 2; history[1][i][k] /= 2; }
+    for(int i = 0; i < 13; ++i) for(int k = 0 ; k < 64; ++k) historyP[i][k] /= 2;
+    ++generation; // counter_history rows are halved lazily, see counterHistory
 }
 
 void CounterT::initCounter(){
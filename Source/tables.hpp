@@ -29,8 +29,21 @@ struct HistoryT{
     ScoreType history[2][64][64]; // color, from, to
     ScoreType historyP[13][64]; // Piece, to
     ScoreType counter_history[13][64][13*64]; //previous moved piece, previous to, current moved piece * boardsize + current to
+    unsigned int counter_historyGen[13][64]; // generation each counter_history row was last aged to
+    unsigned int generation; // incremented by each aging
 
     void initHistory();
+    void ageHistory(); // keep what was learned in previous searches, but with less weight
+
+    // counter_history is too big to be halved at each search, so a row is aged only when it is first used
+    inline ScoreType * counterHistory(Piece pp, Square to){
+        const unsigned int n = std::min(generation - counter_historyGen[pp+PieceShift][to], 15u); // one halving per missed aging
+        if ( n ){
+            for(int k = 0 ; k < 64*13; ++k) counter_history[pp+PieceShift][to][k] /= (1<<n);
+            counter_historyGen[pp+PieceShift][to] = generation;
+        }
+        return counter_history[pp+PieceShift][to];
+    }
 
     template<int S>
     inline void update(DepthType depth, Move m, const Position & p, CMHPtrArray & cmhPtr){
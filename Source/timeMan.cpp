@@ -9,8 +9,9 @@ TimeType msecPerMove, msecInTC, nbMoveInTC, msecInc, msecUntilNextTC, overHead;
 DepthType moveToGo;
 unsigned long long maxKNodes;
 bool isDynamic;
-bool isUCIPondering;
+std::atomic<bool> isUCIPondering;
 std::chrono::time_point<Clock> startTime;
+std::atomic<Clock::rep> budgetStartTicks;
 
 void init(){
     Logging::LogIt(Logging::logInfo) << "Init timeman" ;
@@ -24,7 +25,7 @@ void init(){
     ///@todo a bool for possible emergency functionality
 }
 
-TimeType GetNextMSecPerMove(const Position & p){
+TimeType GetNextMSecPerMove(const Position & p, bool pondering){
     static const TimeType msecMarginMin = 100; // this is HUGE at short TC !
     static const TimeType msecMarginMax = 1000;
     static const float msecMarginCoef   = 0.01f;
@@ -34,7 +35,7 @@ TimeType GetNextMSecPerMove(const Position & p){
     Logging::LogIt(Logging::logInfo) << "msecInc         " << msecInc    ;
     Logging::LogIt(Logging::logInfo) << "nbMoveInTC      " << nbMoveInTC ;
     Logging::LogIt(Logging::logInfo) << "msecUntilNextTC " << msecUntilNextTC;
-    Logging::LogIt(Logging::logInfo) << "currentNbMoves  " << int(p.moves);
+    Logging::LogIt(Logging::logInfo) << "currentNbMoves  " << int(p.moves());
     Logging::LogIt(Logging::logInfo) << "moveToGo        " << int(moveToGo);
     Logging::LogIt(Logging::logInfo) << "maxKNodes       " << maxKNodes;
     TimeType msecIncLoc = (msecInc > 0) ? msecInc : 0;
@@ -52,24 +53,24 @@ TimeType GetNextMSecPerMove(const Position & p){
         Logging::LogIt(Logging::logInfo) << "TC mode, xboard";
         const TimeType msecMargin = std::max(std::min(msecMarginMax, TimeType(msecMarginCoef*msecInTC)), msecMarginMin);
         if (!isDynamic) ms = int((msecInTC - msecMarginMin) / (float)nbMoveInTC) + msecIncLoc ;
-        else { ms = std::min(msecUntilNextTC - msecMargin, int((msecUntilNextTC - msecMargin) /float(nbMoveInTC - ((p.moves - 1) % nbMoveInTC))) + msecIncLoc); }
+        else { ms = std::min(msecUntilNextTC - msecMargin, int((msecUntilNextTC - msecMargin) /float(nbMoveInTC - ((p.moves() - 1) % nbMoveInTC))) + msecIncLoc); }
     }
     else if (moveToGo > 0) { // moveToGo is given (uci style)
         assert(msecUntilNextTC > 0);
         Logging::LogIt(Logging::logInfo) << "UCI style TC";
         const TimeType msecMargin = std::max(std::min(msecMarginMax, TimeType(msecMarginCoef*msecUntilNextTC)), msecMarginMin);
         if (!isDynamic) Logging::LogIt(Logging::logFatal) << "bad timing configuration ...";
-        else { ms = std::min(msecUntilNextTC - msecMargin, TimeType((msecUntilNextTC - msecMargin) / float(moveToGo) + msecIncLoc)*(isUCIPondering?3:2)/2); }
+        else { ms = std::min(msecUntilNextTC - msecMargin, TimeType((msecUntilNextTC - msecMargin) / float(moveToGo) + msecIncLoc)*(pondering?3:2)/2); }
     }
     else{ // mps is not given
         Logging::LogIt(Logging::logInfo) << "Suddendeath style";
         const int nmoves = 17; // always be able to play this more moves !
         Logging::LogIt(Logging::logInfo) << "nmoves    " << nmoves;
-        Logging::LogIt(Logging::logInfo) << "p.moves   " << int(p.moves);
+        Logging::LogIt(Logging::logInfo) << "p.moves   " << int(p.moves());
         assert(nmoves > 0); assert(msecInTC >= 0);
         const TimeType msecMargin = std::max(std::min(msecMarginMax, TimeType(msecMarginCoef*msecInTC)), msecMarginMin);
         if (!isDynamic) ms = int((msecInTC+msecIncLoc-msecMarginMin) / (float)(nmoves)) ;
-        else ms = std::min(msecUntilNextTC - msecMargin, TimeType((msecUntilNextTC - msecMargin) / (float)nmoves + msecIncLoc )*(isUCIPondering?3:2)/2);
+        else ms = std::min(msecUntilNextTC - msecMargin, TimeType((msecUntilNextTC - msecMargin) / (float)nmoves + msecIncLoc )*(pondering?3:2)/2);
     }
     return std::max(ms-overHead, TimeType(20));// if not much time left, let's try that hoping for a friendly GUI...
 }
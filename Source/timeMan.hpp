@@ -9,18 +9,23 @@ struct Position;
  * Then Timeman is responsible to compute msec for next move, using GetNextMSecPerMove(), based on GUI available information.
  * Then Searcher::currentMoveMs is set to GetNextMSecPerMove at the begining of a search.
  * Then, during a search Searcher::getCurrentMoveMs() is used to check the available time.
+ * When pondering, there is no limit until ponderhit, where the budget is computed again (as for a normal search) and counted from the ponderhit instant.
  */
 
 namespace TimeMan{
 extern TimeType msecPerMove, msecInTC, nbMoveInTC, msecInc, msecUntilNextTC, overHead;
 extern DepthType moveToGo;
-extern unsigned long long maxKNodes; ///@todo use this !
+extern unsigned long long maxKNodes; // node limit (in thousands), 0 if none
 extern bool isDynamic;
-extern bool isUCIPondering;
-extern std::chrono::time_point<Clock> startTime;
+extern std::atomic<bool> isUCIPondering; // no time limit while pondering (or in infinite mode), until ponderhit
+extern std::chrono::time_point<Clock> startTime;       // search start
+extern std::atomic<Clock::rep> budgetStartTicks;      // time budget is counted from search start, or from ponderhit (written by the input thread)
+
+inline void setBudgetStart(const std::chrono::time_point<Clock> & t){ budgetStartTicks = t.time_since_epoch().count(); }
+inline std::chrono::time_point<Clock> budgetStart(){ return std::chrono::time_point<Clock>(Clock::duration(budgetStartTicks.load())); }
 
 void init();
 
-TimeType GetNextMSecPerMove(const Position & p);
+TimeType GetNextMSecPerMove(const Position & p, bool pondering); // a pondering search gets a bigger budget
 
 } // TimeMan
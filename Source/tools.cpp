@@ -82,8 +82,8 @@ std::string ToString(const Position & p, bool noEval){
     }
     ss << Logging::_protocolComment[Logging::ct] << " +-+-+-+-+-+-+-+-+" << std::endl;
     if ( p.ep >=0 ) ss << Logging::_protocolComment[Logging::ct] << " ep " << SquareNames[p.ep] << std::endl;
-    //ss << Logging::_protocolComment[Logging::ct] << " wk " << (p.king[Co_White]!=INVALIDSQUARE?SquareNames[p.king[Co_White]]:"none") << std::endl;
-    //ss << Logging::_protocolComment[Logging::ct] << " bk " << (p.king[Co_Black]!=INVALIDSQUARE?SquareNames[p.king[Co_Black]]:"none") << std::endl;
+    //ss << Logging::_protocolComment[Logging::ct] << " wk " << (p.king(Co_White)!=INVALIDSQUARE?SquareNames[p.king(Co_White)]:"none") << std::endl;
+    //ss << Logging::_protocolComment[Logging::ct] << " bk " << (p.king(Co_Black)!=INVALIDSQUARE?SquareNames[p.king(Co_Black)]:"none") << std::endl;
     ss << Logging::_protocolComment[Logging::ct] << " Turn " << (p.c == Co_White ? "white" : "black") << std::endl;
     ScoreType sc = 0;
     if ( ! noEval ){
@@ -1,51 +1,178 @@
 #include "transposition.hpp"
 
+#include "allocator.hpp"
+#include "dynamicConfig.hpp"
+#include "hash.hpp"
 #include "logging.hpp"
 #include "position.hpp"
 #include "searcher.hpp"
 
 namespace{
-    unsigned long long int ttSize = 0;
-    std::unique_ptr<TT::Entry[]> table;
+    unsigned long long int ttSize = 0; // number of buckets
+    std::unique_ptr<TT::Bucket[],Allocator::Deleter> table;
 }
 
 namespace TT{
 
 GenerationType curGen = 0;
 
+// TT file (or shared memory) header, table is following at offset fileHeaderSize (a page size, so that mapped table is aligned)
+const size_t fileHeaderSize = 4096;
+const char fileMagic[8] = "MinicTT";
+struct FileHeader{
+    char magic[8];
+    uint32_t entrySize;
+    uint32_t bucketSize;
+    uint64_t ttSize;
+    Hash zobristCheck;
+    std::atomic<GenerationType> curGen; // in a shared segment, it is written by one process and read by the others
+};
+static_assert(ATOMIC_CHAR_LOCK_FREE == 2, "generation shall be lock free to be shared between processes");
+
+FileHeader * sharedHeader = nullptr; // not null if the table is in a shared memory segment
+bool sharedOwner = false; // the process that created the shared segment is the only one to age it
+
+// saved table is only valid with the same Zobrist keys
+Hash zobristCheck(){
+    Hash h = nullHash;
+    for (int k = 0; k < 64; ++k) for (int j = 0; j < 14; ++j) h = (h << 1 | h >> 63) ^ Zobrist::ZT[k][j];
+    return h;
+}
+
+// magic is written last, so that a header is valid only once fully written
+void fillHeader(FileHeader & header){
+    header.entrySize    = sizeof(Entry);
+    header.bucketSize   = sizeof(Bucket);
+    header.ttSize       = ttSize;
+    header.zobristCheck = zobristCheck();
+    header.curGen       = curGen;
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+}
+
+bool checkHeader(const FileHeader & header, const std::string & name){
+    if ( std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 ){ Logging::LogIt(Logging::logError) << "Not a TT " << name; return false; }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ( header.entrySize != sizeof(Entry) || header.bucketSize != sizeof(Bucket) ){ Logging::LogIt(Logging::logError) << "TT " << name << " uses another entry layout"; return false; }
+    if ( header.zobristCheck != zobristCheck() ){ Logging::LogIt(Logging::logError) << "TT " << name << " uses other Zobrist keys"; return false; }
+    if ( header.ttSize == 0 || (header.ttSize & (header.ttSize - 1)) != 0 ){ Logging::LogIt(Logging::logError) << "Bad TT size in " << name; return false; }
+    return true;
+}
+
+// table in a named shared memory segment, created by the first process, attached by the others
+bool initSharedTable(){
+    const std::string & name = DynamicConfig::ttSharedName;
+    size_t size = ttSize*sizeof(Bucket);
+    bool created = false;
+    Bucket * shared = (Bucket*)Allocator::allocShared(name, fileHeaderSize, size, created);
+    if ( !shared ) return false;
+    FileHeader & header = *(FileHeader*)((char*)shared - fileHeaderSize);
+    if ( created ) fillHeader(header); // memory is already zeroed, that is an empty table
+    else {
+        // creator may still be writing the header
+        for (int k = 0 ; k < 100 && std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 ; ++k) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if ( !checkHeader(header, "shared memory " + name) || size < header.ttSize*sizeof(Bucket) ){ Allocator::free(shared); return false; }
+        ttSize = header.ttSize;
+        curGen = header.curGen;
+    }
+    table.reset(shared);
+    sharedHeader = &header;
+    sharedOwner = created;
+    DynamicConfig::ttSizeMb = (unsigned int)(ttSize*sizeof(Bucket)/1024/1024);
+    return true;
+}
+
 unsigned long long int powerFloor(unsigned long long int x) {
     unsigned long long int power = 1;
-    while (power < x) power *= 2;
-    return power/2;
+    while (2*power <= x) power *= 2;
+    return power;
 }
 
+// can be called again to resize the table between two searches
 void initTable(){
-    assert(table==nullptr);
     Logging::LogIt(Logging::logInfo) << "Init TT" ;
-    Logging::LogIt(Logging::logInfo) << "Entry size " << sizeof(Entry);
-    ttSize = 1024 * powerFloor((DynamicConfig::ttSizeMb * 1024) / (unsigned long long int)sizeof(Entry));
-    table.reset(new Entry[ttSize]);
-    Logging::LogIt(Logging::logInfo) << "Size of TT " << ttSize * sizeof(Entry) / 1024 / 1024 << "Mb" ;
+    table.reset(); // release previous table first, so that memory usage does not double during resize
+    sharedHeader = nullptr;
+    Logging::LogIt(Logging::logInfo) << "Entry size " << sizeof(Entry) << ", bucket size " << sizeof(Bucket);
+    ttSize = 1024 * powerFloor((DynamicConfig::ttSizeMb * 1024) / (unsigned long long int)sizeof(Bucket));
+    if ( !DynamicConfig::ttSharedName.empty() ){
+        if ( initSharedTable() ){ Logging::LogIt(Logging::logInfo) << "Size of shared TT " << ttSize * sizeof(Bucket) / 1024 / 1024 << "Mb"; return; }
+        Logging::LogIt(Logging::logWarn) << "Cannot use shared TT " << DynamicConfig::ttSharedName << ", using a private one";
+    }
+    table.reset((Bucket*)Allocator::alloc(ttSize*sizeof(Bucket), DynamicConfig::largePages, DynamicConfig::numaInterleave ? Allocator::numa_interleave : Allocator::numa_firstTouch));
+    clearTT();
+    Logging::LogIt(Logging::logInfo) << "Size of TT " << ttSize * sizeof(Bucket) / 1024 / 1024 << "Mb" ;
 }
 
 void clearTT() {
+    if ( !table ) return;
+    if ( sharedHeader ){ Logging::LogIt(Logging::logInfo) << "Shared TT is not cleared"; return; } // other processes are using it
     TT::curGen = 0;
-    for (unsigned int k = 0; k < ttSize; ++k) table[k] = { 0, INVALIDMINIMOVE, 0, 0, B_alpha, 0 };
+    const auto start = Clock::now();
+    // each thread clears (and thus first touches) its own slice of the table
+    ThreadPool::instance().parallelRun([](size_t id, size_t n){
+        const unsigned long long int chunk = ttSize / n;
+        const unsigned long long int first = id * chunk;
+        const unsigned long long int last  = id == n - 1 ? ttSize : first + chunk;
+        for (unsigned long long int k = first; k < last; ++k) for (int i = 0 ; i < bucketSize ; ++i) table[k].e[i] = { 0, INVALIDMINIMOVE, 0, 0, B_alpha, 0 };
+    });
+    Logging::LogIt(Logging::logInfo) << "TT cleared in " << std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count() << "ms using " << ThreadPool::instance().size() << " threads";
+}
+
+bool saveTable(const std::string & path){
+    if ( !table ) return false;
+    std::ofstream str(path, std::ios::binary);
+    if ( !str.is_open() ){ Logging::LogIt(Logging::logError) << "Cannot open TT file " << path; return false; }
+    char buffer[fileHeaderSize] = { 0 };
+    fillHeader(*(FileHeader*)buffer);
+    str.write(buffer, fileHeaderSize);
+    str.write((const char*)table.get(), std::streamsize(ttSize*sizeof(Bucket)));
+    if ( !str.good() ){ Logging::LogIt(Logging::logError) << "Error writing TT file " << path; return false; }
+    Logging::LogIt(Logging::logInfo) << "TT saved to " << path << " (" << ttSize*sizeof(Bucket)/1024/1024 << "Mb)";
+    return true;
+}
+
+bool loadTable(const std::string & path){
+    FileHeader header;
+    std::ifstream str(path, std::ios::binary);
+    if ( !str.is_open() || !str.read((char*)&header, sizeof(FileHeader)) ){ Logging::LogIt(Logging::logError) << "Cannot read TT file " << path; return false; }
+    str.close();
+    if ( !checkHeader(header, "file " + path) ) return false;
+    table.reset(); // release current table first
+    sharedHeader = nullptr;
+    size_t size = 0;
+    Bucket * mapped = (Bucket*)Allocator::mapFile(path, fileHeaderSize, size);
+    if ( !mapped || size < header.ttSize*sizeof(Bucket) ){
+        Allocator::free(mapped);
+        Logging::LogIt(Logging::logError) << "Cannot load TT file " << path << ", going back to an empty table";
+        initTable();
+        return false;
+    }
+    table.reset(mapped);
+    ttSize = header.ttSize;
+    curGen = header.curGen;
+    DynamicConfig::ttSizeMb = (unsigned int)(ttSize*sizeof(Bucket)/1024/1024);
+    Logging::LogIt(Logging::logInfo) << "TT loaded from " << path << " (" << DynamicConfig::ttSizeMb << "Mb)";
+    return true;
 }
 
 int hashFull(){
     unsigned long long count = 0;
-    const unsigned int samples = 1023*64;
-    for (unsigned int k = 0; k < samples; ++k) if ( table[(k*67)%ttSize].h ) ++count;
-    return int((count*1000)/samples);
+    const unsigned int samples = 1023*16;
+    for (unsigned int k = 0; k < samples; ++k) for (int i = 0 ; i < bucketSize ; ++i) if ( table[(k*67)%ttSize].e[i].h && table[(k*67)%ttSize].e[i].generation == curGen ) ++count;
+    return int((count*1000)/(samples*bucketSize));
 }
 
+// with a shared table, the generation moves once per search of the creating process, the attached processes follow it
+// (if the creator is gone, the generation does not move anymore and replacement is only depth based)
 void age(){
-    ++TT::curGen;
+    if ( !sharedHeader ) ++TT::curGen;
+    else if ( sharedOwner ) TT::curGen = ++sharedHeader->curGen;
+    else TT::curGen = sharedHeader->curGen;
 }
 
 void prefetch(Hash h) {
-   void * addr = (&table[h&(ttSize-1)]);
+   void * addr = (&table[h&(ttSize-1)]);  // the whole bucket is a single cache line
 #  if defined(__INTEL_COMPILER)
    __asm__ ("");
 #  elif defined(_MSC_VER)
@@ -58,29 +185,55 @@ void prefetch(Hash h) {
 bool getEntry(Searcher & context, const Position & p, Hash h, DepthType d, Entry & e) {
     assert(h > 0);
     if ( DynamicConfig::disableTT  ) return false;
-    Entry & _e = table[h&(ttSize-1)];
+    const MiniHash key = Hash64to32(h);
+    Bucket & bucket = table[h&(ttSize-1)];
+    bool keyFail = false; // an occupied slot failed the key verification
+    for (int i = 0 ; i < bucketSize ; ++i){
+        Entry & _e = bucket.e[i];
 #ifdef DEBUG_HASH_ENTRY
-    _e.d = Zobrist::randomInt<unsigned int>(0, UINT32_MAX);
+        _e.d = Zobrist::randomInt<unsigned int>(0, UINT32_MAX);
 #endif
-    if ( _e.h == 0 ) return false; //early exist cause next ones are also empty ...
-    if ( !VALIDMOVE(_e.m) ||
+        if ( _e.h == 0 ) continue; // empty slot
 #ifndef DEBUG_HASH_ENTRY
-        (_e.h ^ _e._d) != Hash64to32(h) ||
+        if ( (_e.h ^ _e._d) != key ){ keyFail = true; continue; } // another position (or a corrupted entry)
 #endif
-        !isPseudoLegal(p, _e.m)) { _e.h = 0; return false; }
-    e = _e; // update entry only if no collision is detected !
-    if ( _e.d >= d ){ ++context.stats.counters[Stats::sid_tthits]; return true; } // valid entry if depth is ok
-    else return false;
+        if ( !VALIDMOVE(_e.m) )         { context.stats.incTT(Stats::tid_noMove,d);      _e.h = 0; return false; } // cannot be verified
+        if ( !isPseudoLegal(p, _e.m) )  { context.stats.incTT(Stats::tid_pseudoLegal,d); _e.h = 0; return false; } // key collision
+        _e.generation = curGen; // entry is still useful in this search
+        e = _e; // update entry only if no collision is detected !
+        if ( _e.d >= d ){ ++context.stats.counters[Stats::sid_tthits]; context.stats.incTT(Stats::tid_hit,d); return true; } // valid entry if depth is ok
+        else { context.stats.incTT(Stats::tid_shallow,d); return false; }
+    }
+    context.stats.incTT(keyFail ? Stats::tid_keyFail : Stats::tid_miss,d); // a miss, or a bucket holding only other positions
+    return false;
 }
 
-// always replace
+// the less valuable entry is the shallow one from an old search, exact bound are favoured
+inline int entryValue(const Entry & e){ return e.d - 8*GenerationType(curGen - e.generation) + (e.b == B_exact ? 2 : 0); }
+
 void setEntry(Searcher & context, Hash h, Move m, ScoreType s, ScoreType eval, Bound b, DepthType d){
     assert(h > 0);
     if ( DynamicConfig::disableTT ) return;
+    const MiniHash key = Hash64to32(h);
+    Bucket & bucket = table[h&(ttSize-1)];
+    Entry * replace = nullptr;
+    for (int i = 0 ; i < bucketSize ; ++i){
+        Entry & _e = bucket.e[i];
+        if ( _e.h != 0 && (_e.h ^ _e._d) == key ){ // same position
+            // do not let a shallow search of the current generation overwrite a deeper one (except with an exact bound)
+            if ( b != B_exact && d + 3 < _e.d && _e.generation == curGen ) return;
+            if ( !VALIDMOVE(Move2MiniMove(m)) ) m = _e.m; // keep previous best move
+            replace = &_e;
+            break;
+        }
+        if ( !replace || (replace->h != 0 && (_e.h == 0 || entryValue(_e) < entryValue(*replace))) ) replace = &_e;
+    }
     Entry e = {h,m,s,eval,b,d};
     e.h ^= e._d;
     ++context.stats.counters[Stats::sid_ttInsert];
-    table[h&(ttSize-1)] = e; // always replace (favour leaf)
+    context.stats.incTT(Stats::tid_store,d);
+    if ( replace->h != 0 && replace->d > d ) context.stats.incTT(Stats::tid_deepOverwrite,d);
+    *replace = e;
 }
 
 void getPV(const Position & p, Searcher & context, PVList & pv){
@@ -88,7 +241,7 @@ void getPV(const Position & p, Searcher & context, PVList & pv){
     Hash hashStack[MAX_PLY] = { nullHash };
     Position p2 = p;
     bool stop = false;
-    for( int k = 0 ; k < MAX_PLY && !stop; ++k){
+    for( int k = 0 ; k < MAX_DEPTH && !stop; ++k){ // pv capacity is bounded
       if ( !TT::getEntry(context, p2, computeHash(p2), 0, e)) break;
       if (e.h != 0) {
         hashStack[k] = computeHash(p2);
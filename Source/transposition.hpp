@@ -5,11 +5,16 @@
 struct Position;
 struct Searcher;
 
-/* TT in Minic is a very classic 1 entry per bucket cache,
+/* TT in Minic is a bucketed cache, each bucket is a cache line holding a few entries.
  * It stores a 32 bits hash and thus move from TT must be validating before being used
  * An entry is storing both static and evaluation score
- * as well as move, bound and depth.
- * ///@todo test generation !
+ * as well as move, bound, depth and the generation (search number) it was written in.
+ * When a bucket is full, the entry to be replaced is the less valuable one, considering
+ * depth, bound and age, so that a leaf does not overwrite a deep entry of the current search.
+ * The table can be saved to a file and loaded back later (the file is memory mapped, so that
+ * loading is immediate and data is paged in lazily).
+ * The table can also be placed in a named shared memory segment, so that many processes are using the
+ * same table, relying on the same lockless (xor) validation as threads do.
  */
 
 namespace TT{
@@ -18,8 +23,8 @@ extern GenerationType curGen;
 enum Bound : unsigned char{ B_exact = 0, B_alpha = 1, B_beta = 2, B_none = 3};
 #pragma pack(push, 1)
 struct Entry{
-    Entry():m(INVALIDMINIMOVE),h(0),s(0),e(0),b(B_none),d(-1)/*,generation(curGen)*/{}
-    Entry(Hash h, Move m, ScoreType s, ScoreType e, Bound b, DepthType d) : h(Hash64to32(h)), m(Move2MiniMove(m)), s(s), e(e), /*generation(curGen),*/ b(b), d(d){}
+    Entry():m(INVALIDMINIMOVE),h(0),s(0),e(0),b(B_none),d(-1),generation(curGen){}
+    Entry(Hash h, Move m, ScoreType s, ScoreType e, Bound b, DepthType d) : h(Hash64to32(h)), m(Move2MiniMove(m)), s(s), e(e), b(b), d(d), generation(curGen){}
     MiniHash h;            //32
     ScoreType s, e;        //16 + 16
     union{
@@ -30,14 +35,27 @@ struct Entry{
            DepthType d;    //8
         };
     };
-    //GenerationType generation;
+    GenerationType generation; //8
+};
+
+const int bucketSize = 4;
+const int cacheLineSize = 64;
+struct Bucket{
+    Entry e[bucketSize];
+    char padding[cacheLineSize - bucketSize*sizeof(Entry)];
 };
 #pragma pack(pop)
+static_assert(sizeof(Bucket) == cacheLineSize, "TT bucket shall be a cache line");
 
 void initTable();
 
 void clearTT();
 
+bool saveTable(const std::string & path);
+
+// replace current table by the one from the file (in place of initTable and clearTT)
+bool loadTable(const std::string & path);
+
 int hashFull();
 
 void age();
@@ -46,7 +64,7 @@ void prefetch(Hash h);
 
 bool getEntry(Searcher & context, const Position & p, Hash h, DepthType d, Entry & e);
 
-// always replace
+// replace same position entry, else an empty one, else the less valuable one of the bucket
 void setEntry(Searcher & context, Hash h, Move m, ScoreType s, ScoreType eval, Bound b, DepthType d);
 
 void getPV(const Position & p, Searcher & context, PVList & pv);
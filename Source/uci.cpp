@@ -7,6 +7,7 @@
 #include "searcher.hpp"
 #include "timeMan.hpp"
 #include "tools.hpp"
+#include "transposition.hpp"
 
 namespace UCI {
 
@@ -93,11 +94,12 @@ namespace UCI {
                         TimeMan::msecInc = -1;
                         TimeMan::msecUntilNextTC = -1;
                         TimeMan::moveToGo = -1;
+                        TimeMan::maxKNodes = 0;
                         COM::depth = MAX_DEPTH; // infinity
 
                         COM::ponder = COM::p_off;
                         DynamicConfig::mateFinder = false;
-                        TimeMan::isUCIPondering = false;
+                        COM::endPondering();
 
                         std::string param;
                         while (iss >> param) {
@@ -105,7 +107,7 @@ namespace UCI {
                             if      (param == "infinite")    { TimeMan::msecPerMove = INFINITETIME; TimeMan::isUCIPondering = true;}
                             else if (param == "depth")       { int d = 0;  iss >> d; COM::depth = d; }
                             else if (param == "movetime")    { iss >> TimeMan::msecPerMove; }
-                            else if (param == "nodes")       { unsigned long long int maxNodes = 0;  iss >> maxNodes; TimeMan::maxKNodes = int(maxNodes/1000); }
+                            else if (param == "nodes")       { unsigned long long int maxNodes = 0;  iss >> maxNodes; TimeMan::maxKNodes = std::max(1ull,maxNodes/1000); }
                             else if (param == "searchmoves") { Logging::LogIt(Logging::logGUI) << "info string " << param << " not implemented yet"; }
                             else if (param == "wtime")       { int t; iss >> t; if (COM::position.c == Co_White) { TimeMan::msecUntilNextTC = t; TimeMan::isDynamic = true; }}
                             else if (param == "btime")       { int t; iss >> t; if (COM::position.c == Co_Black) { TimeMan::msecUntilNextTC = t; TimeMan::isDynamic = true; }}
@@ -116,6 +118,7 @@ namespace UCI {
                             else if (param == "mate")        { int d = 0;  iss >> d; COM::depth = d; DynamicConfig::mateFinder = true; TimeMan::msecPerMove = INFINITETIME; }
                             else                             { Logging::LogIt(Logging::logGUI) << "info string " << param << " not implemented"; }
                         }
+                        if (!TimeMan::isDynamic && TimeMan::msecPerMove < 0) TimeMan::msecPerMove = INFINITETIME; // "go depth", "go nodes", or just "go"
                         Logging::LogIt(Logging::logInfo) << "uci search launched";
                         COM::thinkAsync(COM::st_searching);
                         Logging::LogIt(Logging::logInfo) << "uci async started";
@@ -125,8 +128,11 @@ namespace UCI {
             }
             else if (uciCommand == "ponderhit") {
                 Logging::LogIt(Logging::logInfo) << "received command ponderhit";
-                //Searcher::stopFlag = true;
-                TimeMan::isUCIPondering = false;
+                // our clock is running from now on, the search goes on with a budget from the clock values given with "go ponder"
+                TimeMan::setBudgetStart(Clock::now());
+                Searcher::currentMoveMs = TimeMan::GetNextMSecPerMove(COM::position, false); // a normal search budget from now on
+                COM::endPondering(); // last, the searcher is using the budget as soon as this is seen
+                Logging::LogIt(Logging::logInfo) << "ponderhit, time budget " << Searcher::currentMoveMs << "ms";
             }
             else if (uciCommand == "ucinewgame") {
                 if (!Searcher::stopFlag) { Logging::LogIt(Logging::logGUI) << "info string " << uciCommand << " received but search in progress ..."; }
@@ -138,6 +144,14 @@ namespace UCI {
                 iss >> type;
                 Logging::LogIt(Logging::logGUI) << "info string " << uciCommand << " not implemented yet";
             }
+            else if (uciCommand == "savett" || uciCommand == "loadtt") {
+                std::string path;
+                iss >> path;
+                if (!Searcher::stopFlag) { Logging::LogIt(Logging::logGUI) << "info string " << uciCommand << " received but search in progress ..."; }
+                else if (path.empty()) { Logging::LogIt(Logging::logGUI) << "info string " << uciCommand << " needs a file name"; }
+                else if (uciCommand == "savett" ? TT::saveTable(path) : TT::loadTable(path)) { Logging::LogIt(Logging::logGUI) << "info string " << uciCommand << " " << path << " done"; }
+                else { Logging::LogIt(Logging::logGUI) << "info string " << uciCommand << " " << path << " failed"; }
+            }
             else if (uciCommand == "print") { Logging::LogIt(Logging::logInfo) << ToString(COM::position); }
             else if (uciCommand == "quit") {
                 COM::stopPonder();
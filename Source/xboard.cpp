@@ -7,6 +7,7 @@
 #include "searcher.hpp"
 #include "timeMan.hpp"
 #include "tools.hpp"
+#include "transposition.hpp"
 
 namespace XBoard{
 
@@ -22,7 +23,7 @@ namespace XBoard{
     void setFeature(){
         ///@todo more feature disable !!
         ///@todo use otim ?
-        Logging::LogIt(Logging::logGUI) << "feature ping=1 setboard=1 edit=0 colors=0 usermove=1 memory=0 sigint=0 sigterm=0 otim=0 time=1 nps=0 draw=0 playother=0 variants=\"normal,fischerandom\" myname=\"Minic " << MinicVersion << "\"";
+        Logging::LogIt(Logging::logGUI) << "feature ping=1 setboard=1 edit=0 colors=0 usermove=1 memory=1 sigint=0 sigterm=0 otim=0 time=1 nps=0 draw=0 playother=0 variants=\"normal,fischerandom\" myname=\"Minic " << MinicVersion << "\"";
         Options::displayOptionsXBoard();
         Logging::LogIt(Logging::logGUI) << "feature done=1";
     }
@@ -101,6 +102,7 @@ namespace XBoard{
                 }
                 else if (COM::command == "new"){ // not following protocol, should set infinite depth search
                     COM::stop();
+                    ThreadPool::instance().clearGame();
                     if (!COM::sideToMoveFromFEN(startPosition)){ commandOK = false; }
                     COM::initialPos = COM::position;
                     DynamicConfig::FRC = false;
@@ -174,6 +176,17 @@ namespace XBoard{
                         COM::readLine();
                     }
                 }
+                else if( strncmp(COM::command.c_str(), "memory",6) == 0) {
+                    COM::stop();
+                    int mb = 0;
+                    sscanf(COM::command.c_str(), "memory %d", &mb);
+                    if ( mb <= 0 || !Options::SetValue("Hash",std::to_string(mb))) Logging::LogIt(Logging::logError) << "Unable to set memory to " << mb << "Mb";
+                }
+                else if( strncmp(COM::command.c_str(), "savett",6) == 0 || strncmp(COM::command.c_str(), "loadtt",6) == 0) { // not in protocol, persist TT
+                    COM::stop();
+                    const std::string path = trim(COM::command.substr(6));
+                    if ( path.empty() || !(COM::command[0] == 's' ? TT::saveTable(path) : TT::loadTable(path)) ) Logging::LogIt(Logging::logError) << "Unable to " << COM::command;
+                }
                 else if( strncmp(COM::command.c_str(), "time",4) == 0) {
                     COM::stopPonder();
                     int centisec = 0;
@@ -254,7 +267,7 @@ namespace XBoard{
                 Logging::LogIt(Logging::logInfo) << "xboard search launched";
                 COM::thinkAsync(COM::state);
                 Logging::LogIt(Logging::logInfo) << "xboard async started";
-                if ( COM::f.valid() ) COM::f.wait(); // synchronous search
+                COM::wait(); // synchronous search
             }
             // if not our turn, and ponder is on, let's think ...
             if(COM::move != INVALIDMOVE && (int)COM::mode == (int)COM::opponent(COM::stm) && COM::ponder == COM::p_on && COM::state == COM::st_none) {
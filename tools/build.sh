@@ -56,11 +56,11 @@ fi
 
 rm -f profile/*
 
-g++ -fprofile-generate=profile $OPT Source/*.cpp -ISource -o $dir/Dist/$exe -lpthread 
+g++ -fprofile-generate=profile $OPT Source/*.cpp -ISource -o $dir/Dist/$exe -lpthread -lrt
 if [ $? = "0" ]; then
    $dir/Dist/$exe -analyze "r2q1rk1/p4ppp/1pb1pn2/8/5P2/1PBB3P/P1PPQ1P1/2KR3R b - - 1 14" 20 -quiet 0 
    #$dir/Dist/$exe -analyze "shirov" 20 
-   g++ -fprofile-use=profile $OPT Source/*.cpp -ISource -o $dir/Dist/$exe -lpthread
+   g++ -fprofile-use=profile $OPT Source/*.cpp -ISource -o $dir/Dist/$exe -lpthread -lrt
 else
    echo "some error"
 fi